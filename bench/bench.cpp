@@ -0,0 +1,304 @@
+#include <ulua.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+#include <optional>
+#include <tuple>
+
+#if defined(__linux__)
+	#include <unistd.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <linux/perf_event.h>
+#endif
+
+// Keeps the compiler from discarding the results of the measured operations.
+//
+static const void* volatile sink = nullptr;
+template<typename T>
+inline void keep( const T& value ) { sink = &value; }
+
+// Counters of the heap allocations made by the C++ side.
+//
+static size_t native_allocations = 0;
+void* operator new( size_t n )
+{
+	native_allocations++;
+	if ( void* p = std::malloc( n ? n : 1 ) )
+		return p;
+	throw std::bad_alloc{};
+}
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, size_t ) noexcept { std::free( p ); }
+
+// Counters of the allocations made by the Lua state, chained to the original allocator.
+//
+struct counting_allocator
+{
+	lua_Alloc next = nullptr;
+	void* next_ud = nullptr;
+	size_t allocations = 0;
+
+	static void* alloc( void* ud, void* ptr, size_t osize, size_t nsize )
+	{
+		auto* self = ( counting_allocator* ) ud;
+		if ( nsize > osize )
+			self->allocations++;
+		return self->next( self->next_ud, ptr, osize, nsize );
+	}
+	void attach( lua_State* L )
+	{
+		next = lua_getallocf( L, &next_ud );
+		lua_setallocf( L, &alloc, this );
+	}
+};
+
+// Retired instruction counter, reports nothing where perf events are unavailable.
+//
+struct instruction_counter
+{
+	int fd = -1;
+
+	instruction_counter()
+	{
+#if defined(__linux__)
+		perf_event_attr attr = {};
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof( attr );
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = int( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+#endif
+	}
+	~instruction_counter()
+	{
+#if defined(__linux__)
+		if ( fd >= 0 )
+			close( fd );
+#endif
+	}
+	bool available() const { return fd >= 0; }
+	void start()
+	{
+#if defined(__linux__)
+		if ( fd >= 0 )
+		{
+			ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+			ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+		}
+#endif
+	}
+	uint64_t stop()
+	{
+		uint64_t count = 0;
+#if defined(__linux__)
+		if ( fd >= 0 )
+		{
+			ioctl( fd, PERF_EVENT_IOC_DISABLE, 0 );
+			if ( read( fd, &count, sizeof( count ) ) != sizeof( count ) )
+				count = 0;
+		}
+#endif
+		return count;
+	}
+};
+
+// Benchmark driver, every case runs its body for the given number of operations.
+//
+struct runner
+{
+	ulua::state& L;
+	counting_allocator& lua_allocs;
+	size_t iterations;
+	instruction_counter instructions = {};
+
+	template<typename F>
+	void run( const char* name, F&& body )
+	{
+		body( iterations / 16 + 1 );
+
+		size_t native_before = native_allocations;
+		size_t lua_before = lua_allocs.allocations;
+		instructions.start();
+		auto t0 = std::chrono::steady_clock::now();
+		body( iterations );
+		auto t1 = std::chrono::steady_clock::now();
+		uint64_t instr = instructions.stop();
+
+		double n = double( iterations );
+		double ns = std::chrono::duration<double, std::nano>( t1 - t0 ).count() / n;
+		double allocs = double( ( native_allocations - native_before ) + ( lua_allocs.allocations - lua_before ) ) / n;
+		if ( instructions.available() )
+			printf( "%-36s %10.2f ns/op %8.3f allocs/op %10.1f instr/op\n", name, ns, allocs, double( instr ) / n );
+		else
+			printf( "%-36s %10.2f ns/op %8.3f allocs/op %10s instr/op\n", name, ns, allocs, "n/a" );
+		lua_gc( L, LUA_GCCOLLECT, 0 );
+	}
+
+	// Round trip of a value through the stack.
+	//
+	template<typename T, typename V>
+	void push_get( const char* name, const V& value )
+	{
+		run( name, [ & ] ( size_t n )
+		{
+			for ( size_t i = 0; i != n; i++ )
+			{
+				ulua::stack::push( L, value );
+				keep( ulua::stack::get<T>( L, -1 ) );
+				ulua::stack::pop_n( L, 1 );
+			}
+		} );
+	}
+
+	// Runs the Lua loop defined under the given global name with the iteration count.
+	//
+	void lua_loop( const char* name, const char* global )
+	{
+		ulua::function loop = L[ global ];
+		run( name, [ & ] ( size_t n ) { loop( double( n ) ).assert(); } );
+	}
+};
+
+struct vec3
+{
+	float x, y, z;
+	vec3 add( const vec3& o ) const { return { x + o.x, y + o.y, z + o.z }; }
+
+	struct lua_traits
+	{
+		static constexpr auto fields = std::tuple{
+			ulua::member<&vec3::x>( "x" ),
+			ulua::member<&vec3::y>( "y" ),
+			ulua::member<&vec3::z>( "z" ),
+			ulua::member<&vec3::add>( "add" ),
+		};
+	};
+};
+static int add_ints( int a, int b ) { return a + b; }
+
+static constexpr const char bench_script[] = R"(
+	function identity( x ) return x end
+	function call_loop( f, n, ... ) for i = 1, n do f( ... ) end end
+	function stateless_loop( n ) call_loop( stateless, n, 1, 2 ) end
+	function stateful_loop( n ) call_loop( stateful, n, 1, 2 ) end
+	function fnptr_loop( n ) call_loop( fnptr, n, 1, 2 ) end
+	function member_loop( n ) call_loop( member, n, va, vb ) end
+	function field_get_loop( n ) local v, s = va, 0 for i = 1, n do s = s + v.x end return s end
+	function field_set_loop( n ) local v = va for i = 1, n do v.y = i end end
+	nested = { a = { b = { c = 0 } } }
+	co = coroutine.create( function() while true do coroutine.yield() end end )
+)";
+
+int main( int argc, const char** argv )
+{
+	size_t iterations = argc > 1 ? size_t( std::strtoull( argv[ 1 ], nullptr, 10 ) ) : 1000000;
+
+	ulua::state L;
+	counting_allocator lua_allocs;
+	lua_allocs.attach( L );
+	L.open_libraries( ulua::lib::base, ulua::lib::string, ulua::lib::table, ulua::lib::math );
+
+#if ULUA_JIT
+	printf( "runtime: %s, ULUA_ACCEL=%d, %zu iterations\n", LUAJIT_VERSION, ULUA_ACCEL, iterations );
+#else
+	printf( "runtime: %s, ULUA_ACCEL=%d, %zu iterations\n", LUA_RELEASE, ULUA_ACCEL, iterations );
+#endif
+
+	std::string cap = "captured";
+	L[ "stateless" ] = [ ] ( int a, int b ) { return a + b; };
+	L[ "stateful" ] = [ cap ] ( int a, int b ) { return a + b + int( cap.size() ); };
+	L[ "fnptr" ] = &add_ints;
+	L[ "member" ] = ulua::constant<&vec3::add>();
+	L[ "va" ] = vec3{ 1, 2, 3 };
+	L[ "vb" ] = vec3{ 4, 5, 6 };
+	L.script( bench_script ).assert();
+
+	runner r{ L, lua_allocs, iterations };
+
+	// Stack round trips of the built-in type traits.
+	//
+	int anchor = 0;
+	vec3 local = { 1, 2, 3 };
+	r.push_get<bool>( "push/get bool", true );
+	r.push_get<int>( "push/get int", 42 );
+	r.push_get<int64_t>( "push/get int64_t", int64_t( 1 ) << 40 );
+	r.push_get<float>( "push/get float", 1.5f );
+	r.push_get<double>( "push/get double", 2.5 );
+	r.push_get<const char*>( "push/get const char*", "const char" );
+	r.push_get<std::string_view>( "push/get std::string_view", std::string_view{ "string view" } );
+	r.push_get<std::string>( "push/get std::string", std::string{ "string" } );
+	r.push_get<ulua::nil_t>( "push/get nil_t", ulua::nil );
+	r.push_get<ulua::light_userdata>( "push/get light_userdata", ulua::light_userdata{ &anchor } );
+	r.push_get<ulua::cfunction_t>( "push/get cfunction_t", ulua::cfunction_t( [ ] ( lua_State* ) { return 0; } ) );
+	r.push_get<std::optional<int>>( "push/get std::optional<int>", std::optional<int>{ 7 } );
+	r.push_get<std::variant<int, std::string_view>>( "push/get std::variant", std::variant<int, std::string_view>{ 7 } );
+	r.push_get<std::vector<int>>( "push/get std::vector<int>[8]", std::vector<int>( 8, 1 ) );
+	r.push_get<vec3>( "push/get userdata vec3", vec3{ 1, 2, 3 } );
+	r.push_get<vec3*>( "push/get userdata vec3*", &local );
+	r.run( "push/get std::tuple<int, double>", [ & ] ( size_t n )
+	{
+		for ( size_t i = 0; i != n; i++ )
+		{
+			int count = ulua::stack::push( L, std::tuple{ 1, 2.0 } );
+			keep( ulua::stack::get<std::tuple<int, double>>( L, -count ) );
+			ulua::stack::pop_n( L, count );
+		}
+	} );
+
+	// Closure invocations from Lua.
+	//
+	r.lua_loop( "closure stateless lambda", "stateless_loop" );
+	r.lua_loop( "closure stateful lambda", "stateful_loop" );
+	r.lua_loop( "closure function pointer", "fnptr_loop" );
+	r.lua_loop( "closure member function", "member_loop" );
+
+	// Userdata fields through the metatable dispatcher.
+	//
+	r.lua_loop( "userdata field get", "field_get_loop" );
+	r.lua_loop( "userdata field set", "field_set_loop" );
+
+	// Table proxy chains from C++.
+	//
+	r.run( "table_proxy chain get", [ & ] ( size_t n )
+	{
+		for ( size_t i = 0; i != n; i++ )
+		{
+			int result = L[ "nested" ][ "a" ][ "b" ][ "c" ];
+			keep( result );
+		}
+	} );
+	r.run( "table_proxy chain set", [ & ] ( size_t n )
+	{
+		for ( size_t i = 0; i != n; i++ )
+			L[ "nested" ][ "a" ][ "b" ][ "c" ] = int( i );
+	} );
+
+	// Protected calls and their results.
+	//
+	ulua::function identity = L[ "identity" ];
+	r.run( "function_result pcall round trip", [ & ] ( size_t n )
+	{
+		for ( size_t i = 0; i != n; i++ )
+		{
+			int result = identity( int( i ) );
+			keep( result );
+		}
+	} );
+
+	// Coroutine resumption.
+	//
+	ulua::coroutine co = L[ "co" ];
+	r.run( "coroutine resume", [ & ] ( size_t n )
+	{
+		for ( size_t i = 0; i != n; i++ )
+			co.resume();
+	} );
+	return 0;
+}
@@ -4,11 +4,15 @@
 #include "ulua/reference.hpp"
 #include "ulua/closure.hpp"
 #include "ulua/lazy.hpp"
+#include "ulua/variadic_args.hpp"
 #include "ulua/table.hpp"
+#include "ulua/containers.hpp"
 #include "ulua/userdata.hpp"
 #include "ulua/userdata_metatable.hpp"
+#include "ulua/callback_list.hpp"
 #include "ulua/environment.hpp"
 #include "ulua/function.hpp"
 #include "ulua/state.hpp"
+#include "ulua/extension.hpp"
 #include "ulua/ffi.hpp"
 #include "ulua/coroutine.hpp"
\ No newline at end of file
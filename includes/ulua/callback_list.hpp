@@ -0,0 +1,186 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "common.hpp"
+#include "stack.hpp"
+#include "table.hpp"
+
+namespace ulua
+{
+	namespace detail
+	{
+		// Calls every live handler in the table with the given arguments, returns nil or the failed handles
+		// interleaved with their error values.
+		//
+		inline constexpr const char callback_dispatcher_code[] = R"(
+			local pcall = pcall
+			return function( handlers, n, ... )
+				local errors, k = nil, 0
+				for i = 1, n do
+					local fn = handlers[ i ]
+					if fn then
+						local ok, err = pcall( fn, ... )
+						if not ok then
+							errors = errors or {}
+							errors[ k + 1 ] = i
+							errors[ k + 2 ] = err
+							k = k + 2
+						end
+					end
+				end
+				if errors then errors.n = k end
+				return errors
+			end
+		)";
+	};
+
+	// List of Lua callbacks stored in a single array table and invoked together in one protected call, slots of
+	// removed handlers are reused by the following additions. Handles pair the slot with its generation so that
+	// a stale handle never refers to the handler that reused its slot.
+	//
+	struct callback_list
+	{
+		using handle = uint64_t;
+		struct error
+		{
+			handle source;
+			std::string message;
+		};
+
+		table handlers = {};
+		std::vector<int> free_slots = {};
+		std::vector<uint32_t> generations = {};
+		int count = 0;
+		size_t live = 0;
+
+		// No slot is reused while dispatching, handlers added meanwhile take new slots past the dispatched range
+		// and slots freed meanwhile are only recycled once the outermost dispatch returns.
+		//
+		mutable std::vector<int> pending_slots = {};
+		mutable int dispatch_depth = 0;
+
+		inline callback_list() {}
+		inline callback_list( lua_State* L, int reserve = 0 ) : handlers( L, create{ reserve_array{ reserve } } ) {}
+
+		// Copies would share the handler table while tracking its free slots separately, so lists are move-only.
+		//
+		callback_list( callback_list&& ) = default;
+		callback_list& operator=( callback_list&& ) = default;
+		callback_list( const callback_list& ) = delete;
+		callback_list& operator=( const callback_list& ) = delete;
+
+		// Observers.
+		//
+		inline lua_State* state() const { return handlers.state(); }
+		inline size_t size() const { return live; }
+		inline bool empty() const { return live == 0; }
+
+		// Handle encoding.
+		//
+		inline handle make_handle( int slot ) const { return ( uint64_t( generations[ slot - 1 ] ) << 32 ) | uint32_t( slot ); }
+		inline static int slot_of( handle h ) { return int( uint32_t( h ) ); }
+
+		// Adds a handler and returns the handle identifying it, values that are neither functions nor have a __call
+		// metamethod are not registered and yield a zero handle.
+		//
+		template<typename F>
+		inline handle add( F&& fn )
+		{
+			lua_State* L = state();
+			stack::push( L, std::forward<F>( fn ) );
+			if ( !stack::type_check<value_type::function>( L, -1 ) )
+			{
+				bool callable = stack::get_meta( L, -1, meta::call );
+				stack::pop_n( L, 1 );
+				if ( !callable )
+					return 0;
+			}
+
+			if ( !dispatch_depth && !pending_slots.empty() )
+			{
+				free_slots.insert( free_slots.end(), pending_slots.begin(), pending_slots.end() );
+				pending_slots.clear();
+			}
+
+			int slot;
+			if ( free_slots.empty() || dispatch_depth )
+			{
+				slot = ++count;
+				generations.push_back( 0 );
+			}
+			else
+			{
+				slot = free_slots.back();
+				free_slots.pop_back();
+				generations[ slot - 1 ]++;
+			}
+			handlers.push();
+			lua_insert( L, -2 );
+			lua_rawseti( L, -2, slot );
+			stack::pop_n( L, 1 );
+			live++;
+			return make_handle( slot );
+		}
+
+		// Removes the handler with the given handle, returns false if it was not registered.
+		//
+		inline bool remove( handle h )
+		{
+			int slot = slot_of( h );
+			if ( slot <= 0 || slot > count || make_handle( slot ) != h )
+				return false;
+			handlers.push();
+			lua_rawgeti( state(), -1, slot );
+			bool removed = lua_toboolean( state(), -1 );
+			stack::pop_n( state(), 1 );
+			if ( removed )
+			{
+				lua_pushboolean( state(), false );
+				lua_rawseti( state(), -2, slot );
+				( dispatch_depth ? pending_slots : free_slots ).push_back( slot );
+				live--;
+			}
+			stack::pop_n( state(), 1 );
+			return removed;
+		}
+
+		// Invokes every handler with the given arguments, returns the errors raised by the failed ones. Errors
+		// raised before any handler is invoked are reported with a zero handle.
+		//
+		template<typename... Tx>
+		inline std::vector<error> operator()( Tx&&... args ) const
+		{
+			std::vector<error> errors = {};
+			if ( !live )
+				return errors;
+
+			lua_State* L = state();
+			detail::push_const_code( L, detail::callback_dispatcher_code );
+			handlers.push();
+			stack::push( L, count );
+			int num_args = stack::push( L, std::forward_as_tuple( std::forward<Tx>( args )... ) );
+			dispatch_depth++;
+			int status = lua_pcall( L, num_args + 2, 1, 0 );
+			dispatch_depth--;
+			if ( status ) [[unlikely]]
+			{
+				errors.push_back( { 0, stack::to_string( L, -1 ) } );
+			}
+			else if ( !stack::type_check<value_type::nil>( L, -1 ) ) [[unlikely]]
+			{
+				stack::get_field( L, -1, "n", raw_t{} );
+				int n = stack::pop<int>( L );
+				for ( int i = 1; i < n; i += 2 )
+				{
+					lua_rawgeti( L, -1, i );
+					handle h = make_handle( stack::pop<int>( L ) );
+					lua_rawgeti( L, -1, i + 1 );
+					errors.push_back( { h, stack::to_string( L, -1 ) } );
+					stack::pop_n( L, 1 );
+				}
+			}
+			stack::pop_n( L, 1 );
+			return errors;
+		}
+	};
+};
@@ -33,6 +33,32 @@ namespace ulua
 			}, stack::get<popped_vtype_t<Args>>( L, 1 ) );
 		}
 
+		// Metatable destroying userdata of the given type on collection, shared by all instances in a state.
+		//
+		template<typename T>
+		struct destructor_metatable
+		{
+			ULUA_COLD static void push_slow( lua_State* L )
+			{
+				stack::create_table( L, reserve_records{ 1 } );
+				stack::push<cfunction_t>( L, [ ] ( lua_State* L )
+				{
+					int uvi = 1;
+					auto* fn = ( T* ) type_traits<userdata_value>::get( L, uvi ).pointer;
+					std::destroy_at( fn );
+					return 0;
+				} );
+				stack::set_field( L, -2, meta::gc );
+				stack::copy( L, -1 );
+				stack::set_cached<destructor_metatable>( L );
+			}
+			ULUA_INLINE inline static void push( lua_State* L )
+			{
+				if ( !stack::push_cached<destructor_metatable>( L ) ) [[unlikely]]
+					push_slow( L );
+			}
+		};
+
 		// Pushes a runtime closure.
 		//
 		template<typename F>
@@ -74,15 +100,7 @@ namespace ulua
 	
 				if constexpr ( !std::is_trivially_destructible_v<Func> )
 				{
-					stack::create_table( L, reserve_records{ 1 } );
-					stack::push<cfunction_t>( L, [ ] ( lua_State* L )
-					{
-						int uvi = 1;
-						auto* fn = ( Func* ) type_traits<userdata_value>::get( L, uvi ).pointer;
-						std::destroy_at( fn );
-						return 0;
-					} );
-					stack::set_field( L, -2, meta::gc );
+					destructor_metatable<Func>::push( L );
 					stack::set_metatable( L, -2 );
 				}
 			}
@@ -91,7 +109,7 @@ namespace ulua
 			else if constexpr ( std::is_void_v<C> )
 			{
 				upvalue_count = 1;
-				stack::push( L, light_userdata{ +func } );
+				stack::push( L, light_userdata{ ( void* ) +func } );
 	
 				wrapper = [ ] ( lua_State* L ) -> int
 				{
@@ -174,6 +192,117 @@ namespace ulua
 		}
 	};
 
+	// Overload resolution.
+	//
+	namespace detail
+	{
+		// Argument signature of an overload, indexed signatures consist only of single slot parameters declaring dispatch
+		// hints and are matched against the argument count and type tags before any conversion is attempted.
+		//
+		inline constexpr size_t max_indexed_arity = 8;
+		struct overload_signature
+		{
+			bool indexed =  false;
+			bool exact =    false;
+			bool packable = false;
+			int min_arity = 0;
+			int max_arity = 0;
+			uint64_t packed = 0;
+			std::array<type_set, max_indexed_arity> slots = {};
+
+			// Checks the packed type tags of the arguments against the signature.
+			//
+			inline constexpr bool match( uint64_t tags ) const
+			{
+				if ( packable )
+					return ( tags & ( max_arity ? ~uint64_t( 0 ) >> ( 64 - 8 * max_arity ) : 0 ) ) == packed;
+				for ( int i = 0; i != max_arity; i++ )
+					if ( !( ( slots[ i ] >> ( ( tags >> ( 8 * i ) ) & 0xFF ) ) & 1 ) )
+						return false;
+				return true;
+			}
+		};
+		template<typename Args>
+		struct make_overload_signature;
+		template<typename... Tx>
+		struct make_overload_signature<std::tuple<Tx...>>
+		{
+			static constexpr overload_signature value = [ ] ()
+			{
+				overload_signature sig = {};
+				sig.indexed = sizeof...( Tx ) <= max_indexed_arity && ( ( accepted_types_of<type_traits<Tx>> != any_type ) && ... );
+				if ( !sig.indexed )
+					return sig;
+
+				type_set accepted[] = { accepted_types_of<type_traits<Tx>>..., 0 };
+				type_set exact[] = { exact_types_of<type_traits<Tx>>..., 0 };
+				sig.exact = true;
+				sig.packable = true;
+				sig.max_arity = int( sizeof...( Tx ) );
+				sig.min_arity = int( sizeof...( Tx ) );
+				for ( size_t i = 0; i != sizeof...( Tx ); i++ )
+				{
+					sig.slots[ i ] = accepted[ i ];
+					sig.exact = sig.exact && accepted[ i ] == exact[ i ];
+					if ( std::popcount( accepted[ i ] ) == 1 )
+						sig.packed |= uint64_t( std::countr_zero( accepted[ i ] ) ) << ( 8 * i );
+					else
+						sig.packable = false;
+				}
+				sig.packable = sig.packable && sig.exact;
+				while ( sig.min_arity && ( accepted[ sig.min_arity - 1 ] & none_type ) )
+					sig.min_arity--;
+				return sig;
+			}();
+		};
+
+		// Picks the first overload accepting the arguments on the stack, preferring the ones matching the argument count
+		// exactly over the ones ignoring trailing arguments. Only unindexed or inexact candidates are trial checked.
+		//
+		template<typename... Args>
+		struct overload_resolver
+		{
+			static constexpr std::array<overload_signature, sizeof...( Args )> signatures = { make_overload_signature<Args>::value... };
+
+			ULUA_INLINE static bool check( lua_State* L, size_t n )
+			{
+				return visit_index<sizeof...( Args )>( n, [ & ] <size_t N> ( const_tag<N> ) -> bool
+				{
+					int i = 1;
+					return type_traits<nth_parameter_t<N, Args...>>::check( L, i );
+				} );
+			}
+			ULUA_INLINE static size_t resolve( lua_State* L )
+			{
+				int top = stack::top( L );
+				uint64_t tags = 0;
+				for ( int i = 0; i != std::min<int>( top, max_indexed_arity ); i++ )
+					tags |= uint64_t( lua_type( L, i + 1 ) + 1 ) << ( 8 * i );
+
+				for ( size_t n = 0; n != sizeof...( Args ); n++ )
+				{
+					const overload_signature& sig = signatures[ n ];
+					if ( sig.indexed )
+					{
+						if ( top < sig.min_arity || top > sig.max_arity || !sig.match( tags ) )
+							continue;
+						if ( sig.exact )
+							return n;
+					}
+					if ( check( L, n ) )
+						return n;
+				}
+				for ( size_t n = 0; n != sizeof...( Args ); n++ )
+				{
+					const overload_signature& sig = signatures[ n ];
+					if ( sig.indexed && top > sig.max_arity && sig.match( tags ) && ( sig.exact || check( L, n ) ) )
+						return n;
+				}
+				return sizeof...( Args );
+			}
+		};
+	};
+
 	// Overload helper.
 	//
 	template<typename... Tx>
@@ -186,19 +315,25 @@ namespace ulua
 
 		template<size_t N> inline constexpr auto& get() { return ( detail::nth_parameter_t<N, Tx...>& ) *this; }
 
-		inline push_count operator()( lua_State* L, arguments arg )
+		inline push_count operator()( lua_State* L )
 		{
-			return detail::visit_index<sizeof...( Tx )>( arg.index(), [ & ] <size_t I> ( ulua::const_tag<I> )
+			using resolver = detail::overload_resolver<detail::popped_vtype_t<typename detail::function_traits<Tx>::arguments>...>;
+			size_t n = resolver::resolve( L );
+			if ( n == sizeof...( Tx ) ) [[unlikely]]
+				arg_error( L, 1, "no matching overload for %d arguments", stack::top( L ) );
+
+			return detail::visit_index<sizeof...( Tx )>( n, [ & ] <size_t I> ( ulua::const_tag<I> )
 			{
-				using R = decltype( std::apply( get<I>(), std::move( std::get<I>( arg ) ) ) );
+				auto arg = stack::get<std::variant_alternative_t<I, arguments>>( L, 1 );
+				using R = decltype( std::apply( get<I>(), std::move( arg ) ) );
 				if constexpr ( std::is_void_v<R> )
 				{
-					std::apply( get<I>(), std::move( std::get<I>( arg ) ) );
+					std::apply( get<I>(), std::move( arg ) );
 					return push_count{ 0 };
 				}
 				else
 				{
-					return push_count{ stack::push( L, std::apply( get<I>(), std::move( std::get<I>( arg ) ) ) ) };
+					return push_count{ stack::push( L, std::apply( get<I>(), std::move( arg ) ) ) };
 				}
 			} );
 		}
@@ -5,6 +5,10 @@
 #include <utility>
 #include <variant>
 #include <array>
+#include <bit>
+#include <string_view>
+#include <string>
+#include <atomic>
 
 #ifndef __has_builtin
 	#define __has_builtin(...) 0
@@ -42,12 +46,12 @@ namespace ulua
 		template<typename T>
 		struct ctti_namer
 		{
-			template<typename __id__ = T>
+			template<typename __id_t = T>
 			static constexpr std::string_view __id__()
 			{
 				auto [sig, begin, delta, end] = std::tuple{
 #if defined(__GNUC__) || defined(__clang__)
-					std::string_view{ __PRETTY_FUNCTION__ }, std::string_view{ "__id__" }, +3, "]"
+					std::string_view{ __PRETTY_FUNCTION__ }, std::string_view{ "__id_t" }, +3, ";]"
 #else
 					std::string_view{ __FUNCSIG__ },         std::string_view{ "__id__" }, +1, ">"
 #endif
@@ -73,7 +77,7 @@ namespace ulua
 
 			static constexpr auto name = [ ] ()
 			{
-				constexpr std::string_view view = ctti_namer<T>::__id__<T>();
+				constexpr std::string_view view = ctti_namer<T>::template __id__<T>();
 				std::array<char, view.length() + 1> data = {};
 				std::copy( view.begin(), view.end(), data.data() );
 				return data;
@@ -83,6 +87,34 @@ namespace ulua
 			inline constexpr operator const char*() const { return &name[ 0 ]; }
 		};
 
+		// Compile time strings.
+		//
+		template<typename T, T... V>
+		struct const_string
+		{
+			static constexpr T data[] = { V..., 0 };
+			static constexpr const char* get() noexcept { return &data[ 0 ]; }
+		};
+
+		// Dense type indices used to address the per-state cache, zero is reserved. Indices are assigned on first
+		// use so that they are valid during dynamic initialization, and each entry is stored along with a tag unique
+		// to the type and the module so that modules with diverging indices sharing a state never read each other's
+		// entries.
+		//
+		inline std::atomic<int> cache_index_counter = 0;
+		inline const char cache_table_key = 0;
+		template<typename T>
+		struct cache_index
+		{
+			inline static const char anchor = 0;
+			inline static int get()
+			{
+				static const int value = ++cache_index_counter;
+				return value;
+			}
+			inline static void* tag() { return ( void* ) &anchor; }
+		};
+
 		// Checks if the type is a tuple or a pair.
 		//
 		template<typename T>               struct is_tuple { static constexpr bool value = false; };
@@ -353,6 +385,109 @@ namespace ulua
 			else return true;
 		}
 
+		// Compile time perfect hash over a set of string keys, maps a key to the index of the only
+		// candidate it could be equal to, which the caller is expected to compare against.
+		//
+		template<size_t N>
+		struct perfect_hash
+		{
+			using index_type = std::conditional_t<( N < 0xFF ), uint8_t, uint16_t>;
+			static constexpr size_t bucket_count = std::bit_ceil( std::max<size_t>( N / 2, 1 ) );
+			static constexpr size_t table_size =   std::bit_ceil( std::max<size_t>( N * 2, 2 ) );
+			static constexpr uint32_t max_seed =   0x10000;
+
+			std::array<uint32_t, bucket_count> seeds = {};
+			std::array<index_type, table_size> table = {};
+			bool sparse = true;
+
+			// Sparse hashes only sample the length and three characters of the key.
+			//
+			ULUA_INLINE inline static constexpr uint32_t hash( std::string_view key, uint32_t seed, bool sparse )
+			{
+				uint32_t h = ( seed ^ uint32_t( key.size() ) ) * 0x01000193;
+				auto mix = [ & ] ( char c ) { h = ( h ^ uint8_t( c ) ) * 0x01000193; };
+				if ( sparse )
+				{
+					if ( !key.empty() )
+					{
+						mix( key.front() );
+						mix( key[ key.size() / 2 ] );
+						mix( key.back() );
+					}
+				}
+				else
+				{
+					for ( char c : key )
+						mix( c );
+				}
+				return h ^ ( h >> 16 );
+			}
+
+			// Hash and displace, keys are distributed into buckets and each bucket searches for a seed that
+			// places all of its keys into free slots, starting with the largest one.
+			//
+			constexpr bool build( const std::array<std::string_view, N>& keys, bool s )
+			{
+				sparse = s;
+				seeds = {};
+				table = {};
+
+				std::array<size_t, N> bucket_of = {};
+				for ( size_t i = 0; i != N; i++ )
+					bucket_of[ i ] = hash( keys[ i ], 0, s ) & ( bucket_count - 1 );
+
+				std::array<bool, bucket_count> done = {};
+				for ( size_t n = 0; n != bucket_count; n++ )
+				{
+					size_t b = 0, bsize = 0;
+					for ( size_t c = 0; c != bucket_count; c++ )
+					{
+						if ( done[ c ] ) continue;
+						size_t csize = std::count( bucket_of.begin(), bucket_of.end(), c );
+						if ( csize >= bsize )
+							b = c, bsize = csize;
+					}
+					done[ b ] = true;
+					if ( !bsize ) continue;
+
+					bool placed = false;
+					for ( uint32_t seed = 1; !placed && seed != max_seed; seed++ )
+					{
+						auto result = table;
+						placed = true;
+						for ( size_t i = 0; placed && i != N; i++ )
+						{
+							if ( bucket_of[ i ] != b ) continue;
+							auto& e = result[ hash( keys[ i ], seed, s ) & ( table_size - 1 ) ];
+							if ( e ) placed = false;
+							else     e = index_type( i + 1 );
+						}
+						if ( placed )
+						{
+							table = result;
+							seeds[ b ] = seed;
+						}
+					}
+					if ( !placed )
+						return false;
+				}
+				return true;
+			}
+			constexpr perfect_hash( const std::array<std::string_view, N>& keys )
+			{
+				if ( !build( keys, true ) && !build( keys, false ) )
+					trap(); // Duplicate keys.
+			}
+
+			// Returns the candidate index or -1.
+			//
+			ULUA_INLINE inline constexpr int find( std::string_view key ) const
+			{
+				uint32_t seed = seeds[ hash( key, 0, sparse ) & ( bucket_count - 1 ) ];
+				return int( table[ hash( key, seed, sparse ) & ( table_size - 1 ) ] ) - 1;
+			}
+		};
+
 		// Visit strategies:
 		//
 		namespace impl
@@ -417,10 +552,10 @@ namespace ulua
 					}
 					else
 					{
-						return fn( const_tag<0ull>{} );
+						return fn( const_tag<size_t( 0 )>{} );
 					}
 				};
-				return apply( const_tag<0ull>{}, apply );
+				return apply( const_tag<size_t( 0 )>{}, apply );
 			}
 			else
 			{
@@ -0,0 +1,153 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <span>
+#include "common.hpp"
+#include "stack.hpp"
+
+namespace ulua
+{
+	// Bulk conversion between sequences and tables.
+	//
+	namespace detail
+	{
+		template<typename T>
+		concept BulkNumber = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+		// Pushes a table with the given values, numbers are written directly into the array part when accelerated.
+		//
+		template<typename T>
+		inline int push_sequence( lua_State* L, std::span<const T> values )
+		{
+			stack::create_table( L, reserve_array{ int( values.size() ) } );
+#if ULUA_ACCEL
+			if constexpr ( BulkNumber<T> )
+			{
+				// Fresh table with only numbers stored in it, no write barrier needed.
+				//
+				GCtab* t = tabV( accel::ref( L, -1 ) );
+				if ( t->asize > values.size() ) [[likely]]
+				{
+					TValue* array = tvref( t->array ) + 1;
+					for ( size_t i = 0; i != values.size(); i++ )
+					{
+						if constexpr ( std::is_integral_v<T> )
+						{
+							detail::set_integer( &array[ i ], values[ i ] );
+						}
+						else
+						{
+							setnumV( &array[ i ], values[ i ] );
+							if ( values[ i ] != values[ i ] ) [[unlikely]]
+								setnanV( &array[ i ] );
+						}
+					}
+					return 1;
+				}
+			}
+#endif
+			for ( size_t i = 0; i != values.size(); i++ )
+			{
+				stack::push( L, values[ i ] );
+				lua_rawseti( L, -2, int( i + 1 ) );
+			}
+			return 1;
+		}
+
+		// Reads the first count elements of the table at the given slot into the output, numbers in the
+		// array part are tag checked in a branchless pass and only converted once all of them are known to be
+		// numbers when accelerated.
+		//
+		template<typename T>
+		inline void get_sequence( lua_State* L, int idx, T* out, size_t count )
+		{
+			idx = stack::abs( L, idx );
+#if ULUA_ACCEL
+			if constexpr ( BulkNumber<T> )
+			{
+				GCtab* t = tabV( accel::ref( L, idx ) );
+				if ( t->asize > count ) [[likely]]
+				{
+					cTValue* array = tvref( t->array ) + 1;
+					bool valid = true;
+					for ( size_t i = 0; i != count; i++ )
+						valid &= bool( tvisnumber( &array[ i ] ) );
+					if ( !valid ) [[unlikely]]
+						arg_error( L, idx, "expected an array of numbers" );
+					for ( size_t i = 0; i != count; i++ )
+					{
+						if constexpr ( std::is_integral_v<T> )
+							out[ i ] = integer_cast<T>( numberVnum( &array[ i ] ) );
+						else
+							out[ i ] = T( numberVnum( &array[ i ] ) );
+					}
+					return;
+				}
+			}
+#endif
+			for ( size_t i = 0; i != count; i++ )
+			{
+				stack::get_field( L, idx, int( i + 1 ), raw_t{} );
+				out[ i ] = stack::pop<T>( L );
+			}
+		}
+	};
+
+	// Implement type traits.
+	//
+	template<typename T, typename A> requires ( !std::is_same_v<T, bool> )
+	struct type_traits<std::vector<T, A>>
+	{
+		ULUA_INLINE static int push( lua_State* L, const std::vector<T, A>& value )
+		{
+			return detail::push_sequence<T>( L, value );
+		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::table>;
+		static constexpr detail::type_set exact_types =    accepted_types;
+		ULUA_INLINE static bool check( lua_State* L, int& idx )
+		{
+			return stack::type_check<value_type::table>( L, idx++ );
+		}
+		ULUA_INLINE static std::vector<T, A> get( lua_State* L, int& idx )
+		{
+			if ( !stack::type_check<value_type::table>( L, idx ) ) [[unlikely]]
+				type_error( L, idx, "table" );
+			std::vector<T, A> result( stack::length( L, idx ) );
+			detail::get_sequence<T>( L, idx++, result.data(), result.size() );
+			return result;
+		}
+	};
+	template<typename T, size_t N>
+	struct type_traits<std::array<T, N>>
+	{
+		ULUA_INLINE static int push( lua_State* L, const std::array<T, N>& value )
+		{
+			return detail::push_sequence<T>( L, value );
+		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::table>;
+		static constexpr detail::type_set exact_types =    0;
+		ULUA_INLINE static bool check( lua_State* L, int& idx )
+		{
+			int i = idx++;
+			return stack::type_check<value_type::table>( L, i ) && stack::length( L, i ) >= N;
+		}
+		ULUA_INLINE static std::array<T, N> get( lua_State* L, int& idx )
+		{
+			if ( !stack::type_check<value_type::table>( L, idx ) ) [[unlikely]]
+				type_error( L, idx, "table" );
+			if ( stack::length( L, idx ) < N ) [[unlikely]]
+				arg_error( L, idx, "expected at least %d elements", int( N ) );
+			std::array<T, N> result;
+			detail::get_sequence<T>( L, idx++, result.data(), N );
+			return result;
+		}
+	};
+	template<typename T, size_t N>
+	struct type_traits<std::span<T, N>>
+	{
+		ULUA_INLINE static int push( lua_State* L, std::span<T, N> value )
+		{
+			return detail::push_sequence<std::remove_const_t<T>>( L, value );
+		}
+	};
+};
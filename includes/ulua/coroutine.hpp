@@ -82,6 +82,8 @@ namespace ulua
 #endif
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::thread>;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return stack::type_check<value_type::thread>( L, idx++ );
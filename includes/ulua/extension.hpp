@@ -0,0 +1,78 @@
+#pragma once
+#include "common.hpp"
+#include "stack.hpp"
+#include "closure.hpp"
+
+namespace ulua
+{
+	// Typed per-state extension storage, allocated as a userdata in the per-state cache so that
+	// it can be reached from any thread of the state with a direct load and is collected along with it.
+	//
+	template<typename T>
+	struct extension
+	{
+		// The instance is also published in the registry under the type name, so that modules sharing the state
+		// but not the cache layout resolve to the same instance. Anonymous type names are module-local so each
+		// module gets its own instance when ULUA_CTTI is set.
+		//
+		ULUA_COLD inline static T* find_slow( lua_State* L )
+		{
+#if !ULUA_CTTI
+			lua_getfield( L, LUA_REGISTRYINDEX, detail::ctti_namer<extension>{} );
+			if ( auto* result = ( T* ) lua_touserdata( L, -1 ) )
+			{
+				stack::set_cached<extension>( L );
+				return result;
+			}
+			stack::pop_n( L, 1 );
+#endif
+			return nullptr;
+		}
+
+		// Gets the instance if it was created.
+		//
+		ULUA_INLINE inline static T* find( lua_State* L )
+		{
+#if ULUA_ACCEL
+			cTValue* tv = stack::ref_cached<extension>( L );
+			if ( !tv || !tvisudata( tv ) ) [[unlikely]]
+				return find_slow( L );
+			return ( T* ) uddata( udataV( tv ) );
+#else
+			if ( !stack::push_cached<extension>( L ) ) [[unlikely]]
+				return find_slow( L );
+			auto* result = ( T* ) lua_touserdata( L, -1 );
+			stack::pop_n( L, 1 );
+			return result;
+#endif
+		}
+
+		// Creates the instance, replacing the previous one if any.
+		//
+		template<typename... Tx>
+		ULUA_COLD inline static T& emplace( lua_State* L, Tx&&... args )
+		{
+			T& result = stack::emplace_userdata<T>( L, std::forward<Tx>( args )... );
+			if constexpr ( !std::is_trivially_destructible_v<T> )
+			{
+				detail::destructor_metatable<T>::push( L );
+				stack::set_metatable( L, -2 );
+			}
+#if !ULUA_CTTI
+			stack::copy( L, -1 );
+			lua_setfield( L, LUA_REGISTRYINDEX, detail::ctti_namer<extension>{} );
+#endif
+			stack::set_cached<extension>( L );
+			return result;
+		}
+
+		// Gets the instance, default constructing it on first use.
+		//
+		ULUA_INLINE inline static T& get( lua_State* L )
+		{
+			if ( T* result = find( L ) ) [[likely]]
+				return *result;
+			return emplace( L );
+		}
+	};
+};
@@ -1,5 +1,5 @@
 #pragma once
-#include <atomic>
+#include <algorithm>
 #include "stack.hpp"
 #include "lazy.hpp"
 #include "table.hpp"
@@ -41,6 +41,26 @@ namespace ulua::ffi
 		stack_table t{ state, LUA_REGISTRYINDEX, weak_t{} };
 		return t[ "_LOADED" ][ "ffi" ][ "metatype" ]( type_name, tbl );
 	}
+
+	// Reference to a C type by its id, pushed as the ctype object.
+	//
+	struct ctype_ref { CTypeID id; };
+};
+
+namespace ulua
+{
+	template<>
+	struct type_traits<ffi::ctype_ref>
+	{
+		ULUA_INLINE static int push( lua_State* L, ffi::ctype_ref value )
+		{
+			auto* cd = lj_cdata_new_( L, CTID_CTYPEID, sizeof( CTypeID ) );
+			*( CTypeID* ) cdataptr( cd ) = value.id;
+			setcdataV( L, L->top, cd );
+			incr_top( L );
+			return 1;
+		}
+	};
 };
 
 namespace ulua
@@ -52,6 +72,8 @@ namespace ulua
 	concept UserCType = std::is_base_of_v<ctype_t, user_traits<T>>;
 	template<typename T>
 	concept CTypeHasInlineCDef = requires { T::cdef; };
+	template<typename T>
+	concept CTypeGeneratesCDef = requires { requires bool( T::generate_cdef ); };
 
 	// Replace userdata wrapper.
 	//
@@ -91,6 +113,14 @@ namespace ulua
 		userdata_by_pointer() = delete;
 	};
 
+	// Generated C definitions.
+	//
+	namespace detail
+	{
+		template<typename T>
+		struct ffi_layout;
+	};
+
 	// Ctype cache.
 	//
 	template<typename T>
@@ -98,21 +128,28 @@ namespace ulua
 	{
 		using meta =  userdata_metatable<T>;
 
-		inline static std::atomic<uint64_t> value = {};
-
+		// Type ids are stored in the per-state cache, so that states on different threads never share the slot.
+		//
 		inline static void write( lua_State* L, CTypeID in )
 		{
-			uint64_t v = uint32_t( ( uint64_t ) L );
-			v |= uint64_t( in ) << 32;
-			value.exchange( v );
+			stack::push( L, in );
+			stack::set_cached<ctype_id_cache>( L );
 		}
-		inline static bool read( lua_State* L, CTypeID& out )
+		ULUA_INLINE static bool read( lua_State* L, CTypeID& out )
 		{
-			uint64_t v = value.load( std::memory_order::relaxed );
-			if ( uint32_t( v ) != uint32_t( ( uint64_t ) L ) ) [[unlikely]]
+#if ULUA_ACCEL
+			cTValue* tv = stack::ref_cached<ctype_id_cache>( L );
+			if ( !tv || !tvisnumber( tv ) ) [[unlikely]]
+				return false;
+			out = CTypeID( numberVnum( tv ) );
+			return true;
+#else
+			if ( !stack::push_cached<ctype_id_cache>( L ) ) [[unlikely]]
 				return false;
-			out = uint32_t( v >> 32 );
+			out = CTypeID( lua_tointeger( L, -1 ) );
+			stack::pop_n( L, 1 );
 			return true;
+#endif
 		}
 		ULUA_COLD static CTypeID fetch_slow( lua_State* L )
 		{
@@ -120,10 +157,15 @@ namespace ulua
 			if ( stack::create_metatable( L, userdata_mt_name<T>().data() ) ) [[unlikely]]
 			{
 				// Create the C definition.
+				static_assert( !( CTypeHasInlineCDef<user_traits<T>> && CTypeGeneratesCDef<user_traits<T>> ), "C type declares both an inline and a generated C definition." );
 				if constexpr ( CTypeHasInlineCDef<user_traits<T>> )
 					ffi::cdef( L, user_traits<T>::cdef ).assert();
+				else if constexpr ( CTypeGeneratesCDef<user_traits<T>> )
+					detail::ffi_layout<T>::define( L );
 				// Get the type ID.
 				type_id = ffi::typeid_of( L, userdata_name<T>().data() );
+				if constexpr ( CTypeGeneratesCDef<user_traits<T>> )
+					detail::ffi_layout<T>::verify( L, type_id );
 				// Setup the metatable.
 				meta::setup( L, stack::top_t{} );
 				// Add the __cid property.
@@ -159,6 +201,8 @@ namespace ulua
 		using cache = ctype_id_cache<std::remove_const_t<T>>;
 
 		// No pusher.
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::cdata>;
+		static constexpr detail::type_set exact_types =    0;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{ 
 			auto* tv = accel::ref( L, idx++ );
@@ -202,6 +246,8 @@ namespace ulua
 		{
 			return emplace( L, std::forward<V>( value ) );
 		}
+		static constexpr detail::type_set accepted_types = detail::accepted_types_of<type_traits<userdata_wrapper<T>>>;
+		static constexpr detail::type_set exact_types =    0;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return type_traits<userdata_wrapper<T>>::check( L, idx );
@@ -212,4 +258,329 @@ namespace ulua
 		}
 	};
 };
-#endif
\ No newline at end of file
+
+// Generated C definitions.
+//
+namespace ulua
+{
+	namespace detail
+	{
+		// Type ids of the types that can be used as pointees.
+		//
+		template<typename T>
+		concept FfiValueType = UserCType<T> || ( ctypes::IntrinsicType<T> && !std::is_pointer_v<T> );
+		template<FfiValueType T>
+		inline CTypeID ffi_type_id( lua_State* L )
+		{
+			if constexpr ( UserCType<T> )
+				return ctype_id_cache<T>::fetch( L );
+			else
+				return ctypes::type_id_v<T>;
+		}
+
+		// Bound data members that are declared as C fields.
+		//
+		template<typename D>
+		concept FfiFieldDescriptor = requires { std::decay_t<D>::getter_type::field; };
+
+		// C definition generated from the bound data members on request of user_traits<T>::generate_cdef. The declaration
+		// mirrors the C++ layout only, binding rules such as readonly members apply to the metatable accessors and are
+		// not visible to the FFI.
+		//
+		template<typename T>
+		struct ffi_layout
+		{
+			using fields_type = std::decay_t<decltype( ulua::userdata_fields<T> )>;
+			template<size_t I> using descriptor = std::decay_t<std::tuple_element_t<I, fields_type>>;
+
+			static constexpr size_t field_count = [ ] <size_t... I> ( std::index_sequence<I...> )
+			{
+				return ( size_t( FfiFieldDescriptor<descriptor<I>> ) + ... + 0 );
+			}( std::make_index_sequence<std::tuple_size_v<fields_type>>{} );
+			static_assert( field_count != 0, "Generated C definitions require at least one bound data member." );
+
+			static constexpr bool is_identifier( std::string_view name )
+			{
+				if ( name.empty() || ( '0' <= name[ 0 ] && name[ 0 ] <= '9' ) )
+					return false;
+				for ( char c : name )
+					if ( !( ( 'a' <= c && c <= 'z' ) || ( 'A' <= c && c <= 'Z' ) || ( '0' <= c && c <= '9' ) || c == '_' ) )
+						return false;
+				return true;
+			}
+
+			template<size_t I>
+			struct field_info
+			{
+				static constexpr auto field = descriptor<I>::getter_type::field;
+				using type = std::remove_cvref_t<decltype( std::declval<T&>().*field )>;
+
+				static_assert( FfiValueType<type>, "Bound data member type cannot be declared in C." );
+			};
+
+			struct entry
+			{
+				size_t offset;
+				size_t size;
+				const char* name;
+				CTypeID id;
+			};
+
+			// Collects the fields in the order of their offsets, member pointers cannot be turned into offsets in constant
+			// expressions so they are measured against uninitialized storage and the result is verified after parsing.
+			//
+			static std::array<entry, field_count> collect( lua_State* L )
+			{
+				alignas( T ) static unsigned char dummy[ sizeof( T ) ];
+				auto* base = ( T* ) &dummy[ 0 ];
+
+				std::array<entry, field_count> entries = {};
+				size_t n = 0;
+				enum_indices<std::tuple_size_v<fields_type>>( [ & ] <size_t I> ( const_tag<I> )
+				{
+					if constexpr ( FfiFieldDescriptor<descriptor<I>> )
+					{
+						using info = field_info<I>;
+						static_assert( sizeof( typename info::type ) <= sizeof( T ) );
+						static_assert( alignof( typename info::type ) <= alignof( T ) );
+						entries[ n++ ] = {
+							size_t( ( unsigned char* ) &( base->*info::field ) - &dummy[ 0 ] ),
+							sizeof( typename info::type ),
+							std::get<I>( ulua::userdata_fields<T> ).name,
+							ffi_type_id<typename info::type>( L )
+						};
+					}
+				} );
+				std::sort( entries.begin(), entries.end(), [ ] ( const entry& a, const entry& b ) { return a.offset < b.offset; } );
+				return entries;
+			}
+
+			// Declares the C structure, padding the gaps between the fields so that the offsets match the C++ layout.
+			//
+			ULUA_COLD static void define( lua_State* L )
+			{
+				static_assert( std::is_standard_layout_v<T>, "C types with generated definitions must be standard layout." );
+#if !ULUA_CTTI
+				static_assert( is_identifier( userdata_name<T>() ), "C types with generated definitions must be named with a valid C identifier." );
+#endif
+				auto entries = collect( L );
+
+				// Generate the declaration.
+				//
+				std::string src = "struct ";
+				src += userdata_name<T>();
+				src += " { ";
+				std::array<ffi::ctype_ref, field_count> ids = {};
+				size_t offset = 0;
+				for ( size_t i = 0; i != field_count; i++ )
+				{
+					const entry& e = entries[ i ];
+					if ( e.offset < offset ) [[unlikely]]
+						error( L, "overlapping C field '%s' in %s", e.name, userdata_name<T>().data() );
+					if ( e.offset != offset )
+						src += "uint8_t __pad" + std::to_string( i ) + "[" + std::to_string( e.offset - offset ) + "]; ";
+					src += "$ ";
+					src += e.name;
+					src += "; ";
+					ids[ i ] = { e.id };
+					offset = e.offset + e.size;
+				}
+				if ( offset != sizeof( T ) )
+					src += "uint8_t __pad[" + std::to_string( sizeof( T ) - offset ) + "]; ";
+				src += "};";
+
+				stack_table t{ L, LUA_REGISTRYINDEX, weak_t{} };
+				std::apply( [ & ] ( auto... ids )
+				{
+					return t[ "_LOADED" ][ "ffi" ][ "cdef" ]( src, ids... );
+				}, ids ).assert();
+			}
+
+			// Validates the size and the field offsets of the parsed type against the C++ layout.
+			//
+			ULUA_COLD static void verify( lua_State* L, CTypeID id )
+			{
+				if ( !id ) [[unlikely]]
+					error( L, "generated C definition of %s was not declared", userdata_name<T>().data() );
+
+				stack_table t{ L, LUA_REGISTRYINDEX, weak_t{} };
+				size_t size = t[ "_LOADED" ][ "ffi" ][ "sizeof" ]( ffi::ctype_ref{ id } );
+				if ( size != sizeof( T ) ) [[unlikely]]
+					error( L, "generated C definition of %s does not match its size", userdata_name<T>().data() );
+				for ( const entry& e : collect( L ) )
+				{
+					size_t offset = t[ "_LOADED" ][ "ffi" ][ "offsetof" ]( ffi::ctype_ref{ id }, e.name );
+					if ( offset != e.offset ) [[unlikely]]
+						error( L, "generated C definition of %s does not match the offset of '%s'", userdata_name<T>().data(), e.name );
+				}
+			}
+		};
+	};
+};
+
+// FFI function exports.
+//
+namespace ulua
+{
+	namespace detail
+	{
+		// C ABI mapping of the argument types, declared with '$' placeholders substituted by the ctype of the id.
+		//
+		template<typename T>
+		struct ffi_argument {};
+		template<ctypes::IntrinsicType T>
+		struct ffi_argument<T>
+		{
+			using type = T;
+			static constexpr const char* decl = "$";
+			inline static CTypeID id( lua_State* ) { return ctypes::type_id_v<T>; }
+			inline static T forward( T value ) { return value; }
+		};
+		template<ctypes::IntrinsicType T> requires ( !std::is_pointer_v<T> )
+		struct ffi_argument<const T&> : ffi_argument<T> {};
+		template<typename T> requires ( FfiValueType<std::remove_const_t<T>> && !ctypes::IntrinsicType<T*> )
+		struct ffi_argument<T*>
+		{
+			using type = T*;
+			static constexpr const char* decl = std::is_const_v<T> ? "const $*" : "$*";
+			inline static CTypeID id( lua_State* L ) { return ffi_type_id<std::remove_const_t<T>>( L ); }
+			inline static T* forward( T* value ) { return value; }
+		};
+		// C types are passed by value so that nil is rejected by the FFI conversion instead of reaching the thunk as
+		// a null reference, mutable references are not mapped.
+		//
+		template<UserCType T> requires std::is_trivially_copyable_v<T>
+		struct ffi_argument<T>
+		{
+			using type = T;
+			static constexpr const char* decl = "$";
+			inline static CTypeID id( lua_State* L ) { return ffi_type_id<T>( L ); }
+			inline static const T& forward( const T& value ) { return value; }
+		};
+		template<UserCType T> requires std::is_trivially_copyable_v<T>
+		struct ffi_argument<const T&> : ffi_argument<T> {};
+
+		// C ABI mapping of the return types.
+		//
+		template<typename T>
+		struct ffi_result {};
+		template<>
+		struct ffi_result<void>
+		{
+			static constexpr const char* decl = "void";
+			inline static std::tuple<> ids( lua_State* ) { return {}; }
+		};
+		template<typename T> requires ( ctypes::IntrinsicType<T> || std::is_pointer_v<T> ) && requires { typename ffi_argument<T>::type; }
+		struct ffi_result<T>
+		{
+			static constexpr const char* decl = ffi_argument<T>::decl;
+			inline static std::tuple<ffi::ctype_ref> ids( lua_State* L ) { return { ffi::ctype_ref{ ffi_argument<T>::id( L ) } }; }
+		};
+		template<UserCType T> requires std::is_trivially_copyable_v<T>
+		struct ffi_result<T>
+		{
+			static constexpr const char* decl = "$";
+			inline static std::tuple<ffi::ctype_ref> ids( lua_State* L ) { return { ffi::ctype_ref{ ffi_type_id<T>( L ) } }; }
+		};
+
+		// Checks whether the constant function can be called through the FFI.
+		//
+		template<typename F, typename Args = typename function_traits<F>::arguments>
+		struct ffi_signature_check { static constexpr bool value = false; };
+		template<typename F, typename... Tx>
+		struct ffi_signature_check<F, std::tuple<Tx...>>
+		{
+			using Traits = function_traits<F>;
+			using C =      typename Traits::owner;
+
+			static constexpr bool value =
+				requires { ffi_result<typename Traits::return_type>::decl; } &&
+				( requires { typename ffi_argument<Tx>::type; } && ... ) &&
+				( Traits::is_lambda || std::is_void_v<C> );
+		};
+		template<auto F>
+		concept FfiExportable = Invocable<decltype( F )> && !function_traits<decltype( F )>::is_vararg && ffi_signature_check<decltype( F )>::value;
+
+		// Generates the C ABI thunk and the function pointer cdata for it, cached per state.
+		//
+		template<auto F, typename Args = typename function_traits<decltype( F )>::arguments>
+		struct ffi_export;
+		template<auto F, typename... Tx>
+		struct ffi_export<F, std::tuple<Tx...>>
+		{
+			using Traits = function_traits<decltype( F )>;
+			using R =      typename Traits::return_type;
+
+			static R invoke( typename ffi_argument<Tx>::type... args )
+			{
+				auto fn = F;
+				return fn( ffi_argument<Tx>::forward( args )... );
+			}
+
+			static std::string prototype()
+			{
+				std::string result = ffi_result<R>::decl;
+				result += "(*)(";
+				( ( result += ffi_argument<Tx>::decl, result += ", " ), ... );
+				if ( result.back() == ' ' )
+					result.resize( result.size() - 2 );
+				result += ")";
+				return result;
+			}
+			static auto type_ids( lua_State* L )
+			{
+				return std::tuple_cat( ffi_result<R>::ids( L ), std::tuple{ ffi::ctype_ref{ ffi_argument<Tx>::id( L ) }... } );
+			}
+
+			ULUA_COLD static void push_slow( lua_State* L )
+			{
+				void* thunk = ( void* ) &invoke;
+
+				{
+					stack_table t{ L, LUA_REGISTRYINDEX, weak_t{} };
+					function_result type = std::apply( [ & ] ( auto... ids )
+					{
+						return t[ "_LOADED" ][ "ffi" ][ "typeof" ]( prototype(), ids... );
+					}, type_ids( L ) );
+					type.assert();
+					function_result pointer = t[ "_LOADED" ][ "ffi" ][ "cast" ]( type.get_ref(), light_userdata{ thunk } );
+					pointer.assert();
+					stack::copy( L, pointer.first );
+					stack::set_cached<ffi_export>( L );
+				}
+				stack::push_cached<ffi_export>( L );
+			}
+			ULUA_INLINE inline static void push( lua_State* L )
+			{
+				if ( !stack::push_cached<ffi_export>( L ) ) [[unlikely]]
+					push_slow( L );
+			}
+		};
+	};
+
+	// Opt-in export of constant functions as FFI function pointers the JIT can call directly, numbers, pointers
+	// and C types by value are allowed in the signature, any other function is pushed as a regular closure.
+	//
+	namespace ffi
+	{
+		template<auto F> struct exported_function {};
+		template<auto F> inline constexpr exported_function<F> exported() { return {}; }
+	};
+	template<auto F> requires detail::Invocable<decltype( F )>
+	struct type_traits<ffi::exported_function<F>>
+	{
+		ULUA_INLINE static int push( lua_State* L, ffi::exported_function<F> )
+		{
+			if constexpr ( detail::FfiExportable<F> )
+			{
+				detail::ffi_export<F>::push( L );
+				return 1;
+			}
+			else
+			{
+				return detail::push_closure( L, const_tag<F>{} );
+			}
+		}
+	};
+};
+#endif
@@ -3,6 +3,7 @@
 #include "reference.hpp"
 #include "stack.hpp"
 #include "lazy.hpp"
+#include "containers.hpp"
 
 namespace ulua
 {
@@ -14,6 +15,7 @@ namespace ulua
 		stack::slot first = 0;
 		stack::slot last = 0;
 		int retval = 0;
+		bool ownership_flag = true;
 
 		// Construction by stack slice, no copy allowed.
 		//
@@ -93,11 +95,16 @@ namespace ulua
 			}
 		}
 
+		// Hands the slots over to the frame if they are above its base, the frame then releases them on exit.
+		//
+		inline void release_to( const stack_frame& frame ) { ownership_flag = !frame.contains( L, first ); }
+
 		// Remove from stack on destruction.
 		//
 		inline ~function_result() 
 		{ 
-			stack::checked_remove( L, first, last - first );
+			if ( ownership_flag )
+				stack::checked_remove( L, first, last - first );
 		}
 	};
 
@@ -123,6 +130,54 @@ namespace ulua
 			//
 			return function_result{ L, bottom + 1, top + 1, pcall_result };
 		}
+
+		// Raises the error on top of the stack left by a failed protected call, the original value is propagated as is.
+		//
+		ULUA_COLD inline void raise_call_error [[noreturn]] ( lua_State* L )
+		{
+			lua_error( L );
+			assume_unreachable();
+		}
+	};
+
+	// Batched invocation.
+	//
+	struct batched_t {};
+	inline constexpr batched_t batched{};
+	namespace detail
+	{
+		// Calls the function with each element of the input table, collects the results into a new table if requested.
+		//
+		inline constexpr const char batch_dispatcher_code[] = R"(
+			return function( fn, input, n, collect )
+				if collect then
+					local output = {}
+					for i = 1, n do
+						output[ i ] = fn( input[ i ] )
+					end
+					return output
+				end
+				for i = 1, n do
+					fn( input[ i ] )
+				end
+			end
+		)";
+
+		// Number of results a call is adjusted to when they are converted into the given type.
+		//
+		template<typename R> inline constexpr int result_count = 1;
+		template<> inline constexpr int result_count<void> = 0;
+		template<typename R> requires is_tuple_v<R> inline constexpr int result_count<R> = int( std::tuple_size_v<R> );
+
+		// Result types that stay valid after the results are popped, views, references and object pointers into the
+		// popped values are rejected.
+		//
+		template<typename R> inline constexpr bool owning_result = !std::is_reference_v<R> && !( std::is_pointer_v<R> && !std::is_function_v<std::remove_pointer_t<R>> );
+		template<> inline constexpr bool owning_result<std::string_view> = false;
+		template<Reference R> inline constexpr bool owning_result<R> = !R::is_direct;
+		template<typename T> inline constexpr bool owning_result<std::optional<T>> = owning_result<T>;
+		template<typename... Tx> inline constexpr bool owning_result<std::tuple<Tx...>> = ( owning_result<Tx> && ... );
+		template<typename T1, typename T2> inline constexpr bool owning_result<std::pair<T1, T2>> = owning_result<T1> && owning_result<T2>;
 	};
 
 	// Function.
@@ -130,6 +185,8 @@ namespace ulua
 	template<Reference Ref>
 	struct basic_function : Ref, detail::lazy_invocable<basic_function<Ref>>
 	{
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::function> | detail::nil_types;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE inline static bool check( lua_State* L, int& slot )
 		{
 			bool res = 
@@ -147,10 +204,197 @@ namespace ulua
 		inline constexpr basic_function() {}
 		template<typename... Tx> requires( sizeof...( Tx ) != 0 && detail::Constructible<Ref, Tx...> )
 		explicit inline constexpr basic_function( Tx&&... ref ) : Ref( std::forward<Tx>( ref )... ) {}
+
+		// Calls the function once per input reusing the same frame, results are converted straight into the output
+		// which must be at least as long as the input. Errors are raised on the first failing element.
+		//
+		template<typename In, typename Out>
+		inline void map( std::span<const In> in, std::span<Out> out ) const
+		{
+			static_assert( detail::owning_result<Out>, "Results are popped after the conversion, the output type must own its value." );
+			constexpr int result_count = detail::result_count<Out>;
+
+			lua_State* L = this->state();
+			if ( out.size() < in.size() ) [[unlikely]]
+				ulua::error( L, "expected %u outputs, got %u", unsigned( in.size() ), unsigned( out.size() ) );
+
+			this->push();
+			for ( size_t i = 0; i != in.size(); i++ )
+			{
+				stack::copy( L, -1 );
+				int num_args = stack::push( L, in[ i ] );
+				if ( lua_pcall( L, num_args, result_count, 0 ) ) [[unlikely]]
+				{
+					lua_remove( L, -2 );
+					detail::raise_call_error( L );
+				}
+				int idx = stack::top( L ) - result_count + 1;
+				out[ i ] = type_traits<Out>::get( L, idx );
+				stack::pop_n( L, result_count );
+			}
+			stack::pop_n( L, 1 );
+		}
+		template<typename In>
+		inline void for_each( std::span<const In> in ) const
+		{
+			lua_State* L = this->state();
+			this->push();
+			for ( size_t i = 0; i != in.size(); i++ )
+			{
+				stack::copy( L, -1 );
+				int num_args = stack::push( L, in[ i ] );
+				if ( lua_pcall( L, num_args, 0, 0 ) ) [[unlikely]]
+				{
+					lua_remove( L, -2 );
+					detail::raise_call_error( L );
+				}
+			}
+			stack::pop_n( L, 1 );
+		}
+
+		// Batched variants running the loop on the Lua side, the inputs are passed as a single table and the whole
+		// batch enters the protected mode once.
+		//
+		template<typename In, typename Out>
+		inline void map( std::span<const In> in, std::span<Out> out, batched_t ) const
+		{
+			static_assert( detail::result_count<Out> == 1, "Batched results are collected into a table, the output type must be a single value." );
+
+			lua_State* L = this->state();
+			if ( out.size() < in.size() ) [[unlikely]]
+				ulua::error( L, "expected %u outputs, got %u", unsigned( in.size() ), unsigned( out.size() ) );
+
+			detail::push_const_code( L, detail::batch_dispatcher_code );
+			this->push();
+			detail::push_sequence<In>( L, in );
+			stack::push( L, int( in.size() ) );
+			stack::push( L, true );
+			if ( lua_pcall( L, 4, 1, 0 ) ) [[unlikely]]
+				detail::raise_call_error( L );
+			detail::get_sequence<Out>( L, -1, out.data(), in.size() );
+			stack::pop_n( L, 1 );
+		}
+		template<typename In>
+		inline void for_each( std::span<const In> in, batched_t ) const
+		{
+			lua_State* L = this->state();
+			detail::push_const_code( L, detail::batch_dispatcher_code );
+			this->push();
+			detail::push_sequence<In>( L, in );
+			stack::push( L, int( in.size() ) );
+			stack::push( L, false );
+			if ( lua_pcall( L, 4, 0, 0 ) ) [[unlikely]]
+				detail::raise_call_error( L );
+		}
 	};
 	using function =       basic_function<registry_reference>;
 	using stack_function = basic_function<stack_reference>;
 
+	// Typed function handle, calls with a fixed number of results worked out from the return type, converts them in
+	// place and pops them at once. Unprotected handles skip the protected call and let errors propagate to the caller.
+	//
+	template<typename Sig, Reference Ref, bool Protected = true>
+	struct basic_function_ref;
+	template<typename R, typename... Args, Reference Ref, bool Protected>
+	struct basic_function_ref<R( Args... ), Ref, Protected> : basic_function<Ref>
+	{
+		static_assert( detail::owning_result<R>, "Results are popped after the conversion, the result type must own its value." );
+		static constexpr int result_count = detail::result_count<R>;
+
+		inline constexpr basic_function_ref() {}
+		template<typename... Tx> requires( sizeof...( Tx ) != 0 && detail::Constructible<Ref, Tx...> )
+		explicit inline constexpr basic_function_ref( Tx&&... ref ) : basic_function<Ref>( std::forward<Tx>( ref )... ) {}
+
+		inline R operator()( Args... args ) const
+		{
+			lua_State* L = this->state();
+			this->push();
+			int num_args = stack::push( L, std::forward_as_tuple( std::forward<Args>( args )... ) );
+			if constexpr ( Protected )
+			{
+				if ( lua_pcall( L, num_args, result_count, 0 ) ) [[unlikely]]
+					detail::raise_call_error( L );
+			}
+			else
+			{
+				lua_call( L, num_args, result_count );
+			}
+
+			if constexpr ( result_count != 0 )
+			{
+				int idx = stack::top( L ) - result_count + 1;
+				R result = type_traits<R>::get( L, idx );
+				stack::pop_n( L, result_count );
+				return result;
+			}
+		}
+	};
+	template<typename Sig> using function_ref =                   basic_function_ref<Sig, registry_reference>;
+	template<typename Sig> using stack_function_ref =             basic_function_ref<Sig, stack_reference>;
+	template<typename Sig> using unprotected_function_ref =       basic_function_ref<Sig, registry_reference, false>;
+	template<typename Sig> using unprotected_stack_function_ref = basic_function_ref<Sig, stack_reference, false>;
+
+	// Global function lookup keeping the last resolved function in a registry slot. The global is looked up on every
+	// access and the handle is only recreated when the lookup yields a different function, so reassignments are seen
+	// on the next access without creating a reference per call. The accelerated path probes the globals table with a
+	// pre-interned key and falls back to the regular lookup for missing or changed slots, such as globals served by
+	// __index.
+	//
+	template<typename F = function>
+	struct global_lookup
+	{
+		lua_State* L = nullptr;
+		std::string name = {};
+		F fn = {};
+		const void* resolved = nullptr;
+#if ULUA_ACCEL
+		registry_reference anchor = {};
+		GCstr* key = nullptr;
+#endif
+
+		inline global_lookup() {}
+		inline global_lookup( lua_State* L, std::string_view name ) : L( L ), name( name )
+		{
+#if ULUA_ACCEL
+			stack::push( L, name );
+			key = strV( accel::ref( L, -1 ) );
+			anchor = registry_reference{ L, stack::top_t{} };
+#endif
+		}
+
+		// Re-resolves the function from the value on top of the stack and pops it.
+		//
+		ULUA_COLD void rebind()
+		{
+			resolved = stack::type_check<value_type::function>( L, -1 ) ? lua_topointer( L, -1 ) : nullptr;
+			fn = F{ L, stack::top_t{} };
+		}
+
+		// Gets the function, resolving it again if the global was reassigned.
+		//
+		inline const F& get()
+		{
+#if ULUA_ACCEL
+			cTValue* tv = lj_tab_getstr( tabref( L->env ), key );
+			if ( tv && tvisfunc( tv ) && ( const void* ) funcV( tv ) == resolved ) [[likely]]
+				return fn;
+#endif
+			lua_getfield( L, LUA_GLOBALSINDEX, name.c_str() );
+			if ( resolved && lua_topointer( L, -1 ) == resolved ) [[likely]]
+			{
+				stack::pop_n( L, 1 );
+				return fn;
+			}
+			rebind();
+			return fn;
+		}
+
+		// Invokes the function.
+		//
+		template<typename... Tx>
+		inline decltype( auto ) operator()( Tx&&... args ) { return get()( std::forward<Tx>( args )... ); }
+	};
+
 	// Pseudo-type for getting the caller.
 	//
 	struct caller_reference : stack_function
@@ -109,13 +109,13 @@ namespace ulua::detail
 	template<typename Ref>
 	struct lazy_invocable
 	{
-		template<typename... Tx> inline function_result operator()( Tx&&... args ) const &
+		template<typename... Tx> inline auto operator()( Tx&&... args ) const &
 		{ 
 			( ( Ref* ) this )->push();
 			return pcall( ( ( Ref* ) this )->state(), std::forward<Tx>( args )... ); 
 		}
 		
-		template<typename... Tx> inline function_result operator()( Tx&&... args ) &&
+		template<typename... Tx> inline auto operator()( Tx&&... args ) &&
 		{ 
 			( ( Ref* ) this )->push();
 			lua_State* state = ( ( Ref* ) this )->state();
@@ -19,6 +19,7 @@ extern "C" {
 		#include <lj_cparse.h>
 		#include <lj_tab.h>
 		#include <lj_str.h>
+		#include <lj_gc.h>
 	};
 	#ifdef ULUA_NO_ACCEL
 		#define ULUA_ACCEL 0
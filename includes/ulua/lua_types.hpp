@@ -5,6 +5,7 @@
 #include <variant>
 #include <tuple>
 #include <optional>
+#include <limits>
 #include "common.hpp"
 
 namespace ulua
@@ -161,7 +162,7 @@ namespace ulua
 		{
 #if !ULUA_ACCEL
 			if constexpr ( T == value_type::nil )
-				return lua_type( L, idx++ ) <= ( int ) value_type::nil;
+				return lua_type( L, i ) <= ( int ) value_type::nil;
 			else
 				return type( L, i ) == T;
 #else
@@ -252,6 +253,57 @@ namespace ulua
 	template<typename T> concept Poppable = std::is_base_of_v<popable_tag_t, type_traits<T>>;
 	template<typename T> concept Emplacable = std::is_base_of_v<emplacable_tag_t, type_traits<T>>;
 
+	// Type dispatch hints, traits may declare the set of Lua types their checker can accept as accepted_types and
+	// the subset where the type tag alone decides the check as exact_types, undeclared traits accept anything.
+	//
+	namespace detail
+	{
+		using type_set = uint32_t;
+		inline constexpr type_set none_type = 1; // LUA_TNONE.
+		inline constexpr type_set any_type =  ~type_set( 0 );
+		template<value_type... T>
+		inline constexpr type_set type_bits = ( type_set( 0 ) | ... | ( type_set( 1 ) << ( int( T ) + 1 ) ) );
+		inline constexpr type_set nil_types = type_bits<value_type::nil> | none_type;
+
+		template<typename X> inline constexpr type_set accepted_types_of = any_type;
+		template<typename X> requires requires { X::accepted_types; } inline constexpr type_set accepted_types_of<X> = X::accepted_types;
+		template<typename X> inline constexpr type_set exact_types_of = 0;
+		template<typename X> requires requires { X::exact_types; } inline constexpr type_set exact_types_of<X> = X::exact_types;
+	};
+
+	// Conversion of numbers to integers, values outside of the 64-bit range saturate instead of being undefined and
+	// the result is truncated to the width of the target.
+	//
+	namespace detail
+	{
+		template<typename T>
+		ULUA_INLINE inline T integer_cast( double n )
+		{
+			if constexpr ( std::is_unsigned_v<T> && sizeof( T ) == sizeof( uint64_t ) )
+			{
+				if ( n >= 0x1p63 ) [[unlikely]]
+					return n < 0x1p64 ? T( n ) : std::numeric_limits<T>::max();
+			}
+			if ( n >= -0x1p63 && n < 0x1p63 ) [[likely]]
+				return T( int64_t( n ) );
+			return T( n > 0 ? std::numeric_limits<int64_t>::max() : n < 0 ? std::numeric_limits<int64_t>::min() : 0 );
+		}
+#if ULUA_ACCEL
+		// Stores an integer into a value slot, wider integers are not truncated to the pointer width.
+		//
+		template<typename T>
+		ULUA_INLINE inline void set_integer( TValue* o, T value )
+		{
+			if constexpr ( sizeof( T ) < sizeof( int32_t ) || ( sizeof( T ) == sizeof( int32_t ) && std::is_signed_v<T> ) )
+				setintV( o, int32_t( value ) );
+			else if constexpr ( std::is_signed_v<T> || sizeof( T ) < sizeof( int64_t ) )
+				setint64V( o, int64_t( value ) );
+			else
+				setnumV( o, lua_Number( value ) );
+		}
+#endif
+	};
+
 	// Primitive type traits.
 	//
 	template<typename T> requires std::is_integral_v<T>
@@ -269,13 +321,19 @@ namespace ulua
 		ULUA_INLINE static int push( lua_State* L, T value )
 		{
 #if ULUA_ACCEL
-			setintptrV( L->top, value );
+			detail::set_integer( L->top, value );
 			incr_top( L );
 #else
 			lua_pushinteger( L, value );
 #endif
 			return 1;
 		}
+#if ULUA_JIT
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::number, value_type::cdata>;
+#else
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::number>;
+#endif
+		static constexpr detail::type_set exact_types =    detail::type_bits<value_type::number>;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 #if ULUA_JIT
@@ -293,7 +351,7 @@ namespace ulua
 			if ( tvisint( tv ) )
 				return ( T ) intV( tv );
 			else if ( tvisnum( tv ) )
-				return ( T ) numV( tv );
+				return detail::integer_cast<T>( numV( tv ) );
 			else if ( tviscdata( tv ) )
 				return get_from_ffi( L, cdataV( tv ), idx - 1 );
 			else
@@ -307,6 +365,8 @@ namespace ulua
 	struct type_traits<T>
 	{
 		using U = std::underlying_type_t<T>;
+		static constexpr detail::type_set accepted_types = type_traits<U>::accepted_types;
+		static constexpr detail::type_set exact_types =    type_traits<U>::exact_types;
 		ULUA_INLINE static int push( lua_State* L, T value ) { return type_traits<U>::push( L, ( U ) value ); }
 		ULUA_INLINE static bool check( lua_State* L, int& idx ) { return type_traits<U>::check( L, idx ); }
 		ULUA_INLINE static T get( lua_State* L, int& idx ) { return ( T ) type_traits<U>::get( L, idx ); }
@@ -335,6 +395,12 @@ namespace ulua
 #endif
 			return 1;
 		}
+#if ULUA_JIT
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::number, value_type::cdata>;
+#else
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::number>;
+#endif
+		static constexpr detail::type_set exact_types =    detail::type_bits<value_type::number>;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 #if ULUA_JIT
@@ -372,6 +438,8 @@ namespace ulua
 			incr_top( L );
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::number, value_type::cdata>;
+		static constexpr detail::type_set exact_types =    detail::type_bits<value_type::number>;
 		ULUA_INLINE static bool check( lua_State* L, int& idx ) {
 			auto* tv = accel::ref( L, idx++ );
 			if ( tvisnum( tv ) || tvisint( tv ) ) return true;
@@ -399,6 +467,8 @@ namespace ulua
 #endif
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::string>;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return stack::type_check<value_type::string>( L, idx++ );
@@ -443,6 +513,8 @@ namespace ulua
 #endif
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::nil_types;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return stack::type_check<value_type::nil>( L, idx++ );
@@ -466,6 +538,8 @@ namespace ulua
 #endif
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::boolean>;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return stack::type_check<value_type::boolean>( L, idx++ );
@@ -487,6 +561,8 @@ namespace ulua
 			lua_pushcfunction( L, value );
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::function>;
+		static constexpr detail::type_set exact_types =    0;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return lua_tocfunction( L, idx++ );
@@ -507,6 +583,8 @@ namespace ulua
 			lua_pushlightuserdata( L, value );
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::light_userdata>;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return stack::type_check<value_type::light_userdata>( L, idx++ );
@@ -527,6 +605,8 @@ namespace ulua
 	struct type_traits<userdata_value>
 	{
 		// No pusher.
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::userdata>;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return stack::type_check<value_type::userdata>( L, idx++ );
@@ -564,34 +644,95 @@ namespace ulua
 				return type_traits<T>::push( L, std::forward<T>( v ) );
 			} );
 		}
-		ULUA_INLINE static bool check( lua_State* L, int& idx )
+		// Candidate alternatives for each type tag in declaration order, cut short after the first alternative
+		// whose check is decided by the tag alone so that most lookups resolve to a single candidate.
+		//
+		static constexpr size_t tag_count = 16;
+		struct dispatch_entry
 		{
-			bool valid = false;
-			detail::enum_indices<sizeof...( Tx )>( [ & ] <size_t N> ( const_tag<N> )
+			uint64_t candidates = 0;
+			uint64_t exact = 0;
+		};
+		static constexpr std::array<dispatch_entry, tag_count> dispatch_table = [ ] ()
+		{
+			std::array<dispatch_entry, tag_count> table = {};
+			if constexpr ( sizeof...( Tx ) <= 64 )
 			{
-				using T = std::variant_alternative_t<N, std::variant<Tx...>>;
-				if ( valid ) return;
+				for ( size_t tag = 0; tag != tag_count; tag++ )
+				{
+					bool closed = false;
+					detail::enum_indices<sizeof...( Tx )>( [ & ] <size_t N> ( const_tag<N> )
+					{
+						using T = type_traits<detail::nth_parameter_t<N, Tx...>>;
+						if ( closed || !( ( detail::accepted_types_of<T> >> tag ) & 1 ) ) return;
+						table[ tag ].candidates |= uint64_t( 1 ) << N;
+						if ( ( detail::exact_types_of<T> >> tag ) & 1 )
+						{
+							table[ tag ].exact |= uint64_t( 1 ) << N;
+							closed = true;
+						}
+					} );
+				}
+			}
+			return table;
+		}();
 
-				int i = idx;
-				if ( type_traits<T>::check( L, i ) )
+		// Invokes the callback with the index of the first alternative accepting the value and the slot following it,
+		// reads the type tag once and only checks the candidates listed for it.
+		//
+		template<typename F>
+		ULUA_INLINE static bool dispatch( lua_State* L, int idx, F&& fn )
+		{
+			if constexpr ( sizeof...( Tx ) <= 64 )
+			{
+				const dispatch_entry& entry = dispatch_table[ size_t( int( stack::type( L, idx ) ) + 1 ) & ( tag_count - 1 ) ];
+				for ( uint64_t mask = entry.candidates; mask; mask &= mask - 1 )
 				{
-					idx = i;
-					valid = true;
+					size_t n = std::countr_zero( mask );
+					bool exact = ( entry.exact >> n ) & 1;
+					bool found = detail::visit_index<sizeof...( Tx )>( n, [ & ] <size_t N> ( const_tag<N> ) -> bool
+					{
+						int i = idx;
+						if ( exact )
+							i++;
+						else if ( !type_traits<detail::nth_parameter_t<N, Tx...>>::check( L, i ) )
+							return false;
+						fn( const_tag<N>{}, i );
+						return true;
+					} );
+					if ( found )
+						return true;
 				}
-			} );
-			return valid;
+				return false;
+			}
+			else
+			{
+				bool found = false;
+				detail::enum_indices<sizeof...( Tx )>( [ & ] <size_t N> ( const_tag<N> )
+				{
+					if ( found ) return;
+					int i = idx;
+					if ( type_traits<detail::nth_parameter_t<N, Tx...>>::check( L, i ) )
+					{
+						fn( const_tag<N>{}, i );
+						found = true;
+					}
+				} );
+				return found;
+			}
+		}
+
+		ULUA_INLINE static bool check( lua_State* L, int& idx )
+		{
+			return dispatch( L, idx, [ & ] <size_t N> ( const_tag<N>, int next ) { idx = next; } );
 		}
 		ULUA_INLINE static std::variant<Tx...> get( lua_State* L, int& idx )
 		{
 			std::optional<std::variant<Tx...>> result = {};
-			detail::enum_indices<sizeof...( Tx )>( [ & ] <size_t N> ( const_tag<N> )
+			dispatch( L, idx, [ & ] <size_t N> ( const_tag<N>, int )
 			{
 				using T = detail::nth_parameter_t<N, Tx...>;
-				if ( result.has_value() ) return;
-
-				int i = idx;
-				if ( type_traits<T>::check( L, i ) )
-					result.emplace( std::in_place_index_t<N>{}, type_traits<T>::get( L, idx ) );
+				result.emplace( std::in_place_index_t<N>{}, type_traits<T>::get( L, idx ) );
 			} );
 			if ( !result.has_value() )
 			{
@@ -614,6 +755,8 @@ namespace ulua
 			if ( !value ) return type_traits<nil_t>::push( L, nil );
 			else          return type_traits<typename std::remove_cvref_t<Opt>::value_type>::push( L, std::forward<Opt>( value ).value() );
 		}
+		static constexpr detail::type_set accepted_types = detail::nil_types | detail::accepted_types_of<type_traits<T>>;
+		static constexpr detail::type_set exact_types =    detail::nil_types | detail::exact_types_of<type_traits<T>>;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			int i = idx;
@@ -683,6 +826,8 @@ namespace ulua
 	template<>
 	struct type_traits<std::nullopt_t>
 	{
+		static constexpr detail::type_set accepted_types = detail::nil_types;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static int push( lua_State* L, std::nullopt_t ) { return type_traits<nil_t>::push( L, nil ); }
 		ULUA_INLINE static bool check( lua_State* L, int& idx ) { return type_traits<nil_t>::check( L, idx ); }
 		ULUA_INLINE static std::nullopt_t get( lua_State*, int& idx ) { idx++; return std::nullopt; }
@@ -690,6 +835,8 @@ namespace ulua
 	template<>
 	struct type_traits<std::nullptr_t>
 	{
+		static constexpr detail::type_set accepted_types = detail::nil_types;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static int push( lua_State* L, std::nullptr_t ) { return type_traits<nil_t>::push( L, nil ); }
 		ULUA_INLINE static bool check( lua_State* L, int& idx ) { return type_traits<nil_t>::check( L, idx ); }
 		ULUA_INLINE static std::nullptr_t get( lua_State*, int& idx ) { idx++; return nullptr; }
@@ -719,6 +866,8 @@ namespace ulua
 			incr_top( L );
 			return 1;
 		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::cdata>;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE static bool check( lua_State* L, int& idx )
 		{
 			return stack::type_check<value_type::cdata>( L, idx++ );
@@ -4,16 +4,6 @@
 
 namespace ulua
 {
-	namespace detail
-	{
-		template<typename T, T... V>
-		struct const_string
-		{
-			static constexpr T data[] = { V..., 0 };
-			static constexpr const char* get() noexcept { return &data[ 0 ]; }
-		};
-	};
-
 	// Named arguments.
 	//
 	template<typename T, auto N>
@@ -56,5 +46,138 @@ namespace ulua
 	};
 };
 
+namespace ulua
+{
+	// Named argument sets, decoded from the option table in a single traversal with the keys
+	// dispatched through a compile time perfect hash. Strict sets reject unknown keys.
+	//
+	namespace detail
+	{
+		template<typename T> struct is_optional : std::false_type {};
+		template<typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+		template<typename T>
+		struct named_traits;
+		template<typename T, auto N>
+		struct named_traits<named<T, N>>
+		{
+			using type = T;
+			static constexpr std::string_view name = N.get();
+			static constexpr bool is_optional = is_optional<T>::value;
+		};
+	};
+	template<bool Strict, typename... Tx>
+	struct basic_named_args : std::tuple<Tx...>
+	{
+		using std::tuple<Tx...>::tuple;
+
+		// Gets an argument by its index or name.
+		//
+		template<size_t I> inline auto& get() { return std::get<I>( *this ); }
+		template<size_t I> inline const auto& get() const { return std::get<I>( *this ); }
+		template<auto N> requires ( !std::is_integral_v<decltype( N )> ) inline auto& get() { return std::get<index_of<N>()>( *this ); }
+		template<auto N> requires ( !std::is_integral_v<decltype( N )> ) inline const auto& get() const { return std::get<index_of<N>()>( *this ); }
+
+		template<auto N>
+		static constexpr size_t index_of()
+		{
+			constexpr std::string_view names[] = { detail::named_traits<Tx>::name... };
+			for ( size_t i = 0; i != sizeof...( Tx ); i++ )
+				if ( names[ i ] == std::string_view{ N.get() } )
+					return i;
+			detail::trap();
+		}
+	};
+	template<typename... Tx> using named_args = basic_named_args<false, Tx...>;
+	template<typename... Tx> using strict_named_args = basic_named_args<true, Tx...>;
+
+	template<bool Strict, typename... Tx>
+	struct type_traits<basic_named_args<Strict, Tx...>>
+	{
+		static constexpr size_t count = sizeof...( Tx );
+		static constexpr std::array<std::string_view, count> names = { detail::named_traits<Tx>::name... };
+		static constexpr detail::perfect_hash<count> hash{ names };
+
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::table>;
+		static constexpr detail::type_set exact_types =    accepted_types;
+		ULUA_INLINE static bool check( lua_State* L, int& idx )
+		{
+			return stack::type_check<value_type::table>( L, idx++ );
+		}
+		ULUA_INLINE static basic_named_args<Strict, Tx...> get( lua_State* L, int& idx )
+		{
+			int i = stack::abs( L, idx++ );
+			if ( !stack::type_check<value_type::table>( L, i ) ) [[unlikely]]
+				type_error( L, i, "table" );
+
+			// Decode every key in a single traversal.
+			//
+			std::tuple<std::optional<typename detail::named_traits<Tx>::type>...> values;
+			stack::push( L, nil );
+			while ( lua_next( L, i ) )
+			{
+				bool known = false;
+				if ( stack::type_check<value_type::string>( L, -2 ) )
+				{
+					int k = stack::top( L ) - 1;
+					std::string_view key = type_traits<std::string_view>::get( L, k );
+					int n = hash.find( key );
+					if ( n >= 0 )
+					{
+						known = detail::visit_index<count>( size_t( n ), [ & ] <size_t I> ( const_tag<I> ) ULUA_INLINE -> bool
+						{
+							constexpr std::string_view name = names[ I ];
+							if ( key.size() != name.size() || !detail::const_eq<name.size()>( key.data(), name.data() ) )
+								return false;
+							using T = typename detail::named_traits<detail::nth_parameter_t<I, Tx...>>::type;
+							if ( !stack::check<T>( L, stack::top( L ) ) ) [[unlikely]]
+								arg_error( L, i, "bad option '%s' (got %s)", name.data(), luaL_typename( L, -1 ) );
+							std::get<I>( values ).emplace( stack::get<T>( L, stack::top( L ) ) );
+							return true;
+						} );
+					}
+					if constexpr ( Strict )
+					{
+						if ( !known ) [[unlikely]]
+							arg_error( L, i, "unknown option '%s'", std::string{ key }.c_str() );
+					}
+				}
+				else if constexpr ( Strict )
+				{
+					arg_error( L, i, "unexpected %s key", lua_typename( L, lua_type( L, -2 ) ) );
+				}
+				stack::pop_n( L, 1 );
+			}
+
+			// Check for missing arguments.
+			//
+			detail::enum_indices<count>( [ & ] <size_t I> ( const_tag<I> )
+			{
+				using Traits = detail::named_traits<detail::nth_parameter_t<I, Tx...>>;
+				if constexpr ( !Traits::is_optional )
+				{
+					if ( !std::get<I>( values ) ) [[unlikely]]
+						arg_error( L, i, "missing option '%s'", names[ I ].data() );
+				}
+			} );
+			return std::apply( [ ] ( auto&&... values )
+			{
+				return basic_named_args<Strict, Tx...>{ make_argument<Tx>( std::move( values ) )... };
+			}, std::move( values ) );
+		}
+
+		// Constructs an argument from its decoded value, required arguments are never default-constructed.
+		//
+		template<typename N, typename T>
+		ULUA_INLINE static N make_argument( std::optional<T>&& value )
+		{
+			if constexpr ( detail::named_traits<N>::is_optional )
+				return N( value ? std::move( *value ) : T{} );
+			else
+				return N( std::move( *value ) );
+		}
+	};
+};
+
 template<typename T, T... V>
 static constexpr auto operator""_n() { return ulua::detail::const_string<T, V...>{}; }
\ No newline at end of file
@@ -46,6 +46,7 @@ namespace ulua
 		inline constexpr stack_reference( nullref_t ) {}
 		inline constexpr stack_reference( lua_State* L, int index ) : L( L ), index( stack::abs( L, index ) ), ownership_flag( true ) { detail::assume_true( this->index != invalid_value ); }
 		inline constexpr stack_reference( lua_State* L, int index, weak_t ) : L( L ), index( stack::abs( L, index ) ), ownership_flag( false ) { detail::assume_true( this->index != invalid_value ); }
+		inline stack_reference( lua_State* L, int index, const stack_frame& frame ) : L( L ), index( stack::abs( L, index ) ), ownership_flag( !frame.contains( L, this->index ) ) { detail::assume_true( this->index != invalid_value ); }
 
 		inline constexpr stack_reference( stack_reference&& o ) noexcept { swap( o ); }
 		inline constexpr stack_reference& operator=( stack_reference&& o ) noexcept { swap( o ); return *this; }
@@ -165,6 +166,8 @@ namespace ulua
 	struct type_traits<R> : popable_tag_t
 	{
 		ULUA_INLINE inline static int push( lua_State* L, const R& ref ) { ref.push(); return 1; }
+		static constexpr detail::type_set accepted_types = detail::accepted_types_of<R>;
+		static constexpr detail::type_set exact_types =    detail::exact_types_of<R>;
 		ULUA_INLINE inline static bool check( lua_State* L, int& idx ) { return R::check( L, idx ); }
 		ULUA_INLINE inline static R get( lua_State* L, int& idx ) 
 		{ 
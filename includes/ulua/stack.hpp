@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <span>
+#include <cstring>
 #include "common.hpp"
 #include "lua_types.hpp"
 
@@ -98,18 +99,40 @@ namespace ulua::stack
 #endif
 	}
 
-	// Removes a number of stack elements at the given position.
+	// Removes a number of stack elements at the given position, shifting the elements above down in a single pass.
 	//
 	inline void remove( lua_State* L, slot i, size_t n = 1 )
 	{
-		while ( n )
-			lua_remove( L, i + --n );
+		if ( !n ) return;
+#if ULUA_ACCEL
+		TValue* first = accel::ref( L, i );
+		memmove( first, first + n, ( L->top - ( first + n ) ) * sizeof( TValue ) );
+		L->top -= n;
+#else
+		slot t = top( L );
+		if ( i < 0 )
+			i = t + i + 1;
+		for ( slot j = i + slot( n ); j <= t; j++ )
+		{
+			lua_pushvalue( L, j );
+			lua_replace( L, j - slot( n ) );
+		}
+		lua_settop( L, t - slot( n ) );
+#endif
 	}
 
 	// Pushes a given item on the stack to the top of the stack.
 	//
 	inline void copy( lua_State* L, slot src ) { lua_pushvalue( L, src ); }
+#if LUA_VERSION_NUM >= 502 || LUAJIT_VERSION_NUM >= 20100
 	inline void copy( lua_State* L, slot src, slot dst ) { lua_copy( L, src, dst ); }
+#else
+	inline void copy( lua_State* L, slot src, slot dst )
+	{
+		lua_pushvalue( L, src );
+		lua_replace( L, ( dst < 0 && dst > LUA_REGISTRYINDEX ) ? dst - 1 : dst );
+	}
+#endif
 	
 	// Slot traits.
 	//
@@ -191,12 +214,21 @@ namespace ulua::stack
 		lua_xmove( from, to, count );
 	}
 	
+	// Keys implementing their own table accessors, such as interned keys and paths declared below.
+	//
+	template<typename T>
+	concept CustomKey = requires { T::is_custom_key; };
+
 	// Fetches a specific key from the table and pushes it.
 	//
 	template<typename T, bool Raw = false>
 	inline void get_field( lua_State* L, slot i, const T& key, std::bool_constant<Raw> = {} )
 	{
-		if constexpr ( std::is_same_v<T, meta> )
+		if constexpr ( CustomKey<T> )
+		{
+			T::get_field( L, i, std::bool_constant<Raw>{} );
+		}
+		else if constexpr ( std::is_same_v<T, meta> )
 		{
 			get_field( L, i, metafield_name( key ), std::bool_constant<true>{} );
 		}
@@ -237,7 +269,11 @@ namespace ulua::stack
 	template<typename T, bool Raw = false>
 	inline void set_field( lua_State* L, slot i, const T& key, std::bool_constant<Raw> = {} )
 	{
-		if constexpr ( std::is_same_v<T, meta> )
+		if constexpr ( CustomKey<T> )
+		{
+			T::set_field( L, i, std::bool_constant<Raw>{} );
+		}
+		else if constexpr ( std::is_same_v<T, meta> )
 		{
 			set_field( L, i, metafield_name( key ), std::bool_constant<true>{} );
 		}
@@ -317,6 +353,94 @@ namespace ulua::stack
 		lua_setmetatable( L, i );
 	}
 
+	// Per-state cache, stored in the array part of a table the registry holds under a private light userdata
+	// key. Each key type owns two slots, its tag followed by the value, and entries with a foreign tag are
+	// treated as missing. Pushes the value and returns true if it exists. The accelerated path can also
+	// reference the value in place.
+	//
+	inline bool push_cache_table( lua_State* L )
+	{
+		lua_pushlightuserdata( L, ( void* ) &detail::cache_table_key );
+		lua_rawget( L, LUA_REGISTRYINDEX );
+		if ( type_check<value_type::table>( L, -1 ) ) [[likely]]
+			return true;
+		pop_n( L, 1 );
+		return false;
+	}
+#if ULUA_ACCEL
+	template<typename K>
+	ULUA_INLINE inline cTValue* ref_cached( lua_State* L )
+	{
+		lua_pushlightuserdata( L, ( void* ) &detail::cache_table_key );
+		cTValue* entry = lj_tab_get( L, tabV( registry( L ) ), L->top - 1 );
+		L->top--;
+		if ( !tvistab( entry ) ) [[unlikely]]
+			return nullptr;
+		GCtab* cache = tabV( entry );
+		int index = detail::cache_index<K>::get() * 2;
+		cTValue* tag = lj_tab_getint( cache, index );
+		if ( !tag || !tvislightud( tag ) || lightudV( G( L ), tag ) != detail::cache_index<K>::tag() ) [[unlikely]]
+			return nullptr;
+		cTValue* tv = lj_tab_getint( cache, index + 1 );
+		if ( !tv || tvisnil( tv ) ) [[unlikely]]
+			return nullptr;
+		return tv;
+	}
+#endif
+	template<typename K>
+	ULUA_INLINE inline bool push_cached( lua_State* L )
+	{
+#if ULUA_ACCEL
+		if ( cTValue* tv = ref_cached<K>( L ) ) [[likely]]
+		{
+			copyTV( L, L->top, tv );
+			incr_top( L );
+			return true;
+		}
+		return false;
+#else
+		if ( !push_cache_table( L ) ) [[unlikely]]
+			return false;
+		int index = detail::cache_index<K>::get() * 2;
+		lua_rawgeti( L, -1, index );
+		bool match = lua_touserdata( L, -1 ) == detail::cache_index<K>::tag();
+		pop_n( L, 1 );
+		if ( !match ) [[unlikely]]
+		{
+			pop_n( L, 1 );
+			return false;
+		}
+		lua_rawgeti( L, -1, index + 1 );
+		lua_remove( L, -2 );
+		if ( type_check<value_type::nil>( L, -1 ) ) [[unlikely]]
+		{
+			pop_n( L, 1 );
+			return false;
+		}
+		return true;
+#endif
+	}
+
+	// Pops a value off of the stack and stores it in the per-state cache under the given key type.
+	//
+	template<typename K>
+	ULUA_COLD inline void set_cached( lua_State* L )
+	{
+		int index = detail::cache_index<K>::get() * 2;
+		if ( !push_cache_table( L ) )
+		{
+			create_table( L, reserve_array{ 2 * ( detail::cache_index_counter + 1 ) } );
+			lua_pushlightuserdata( L, ( void* ) &detail::cache_table_key );
+			copy( L, -2 );
+			lua_rawset( L, LUA_REGISTRYINDEX );
+		}
+		lua_pushlightuserdata( L, detail::cache_index<K>::tag() );
+		lua_rawseti( L, -2, index );
+		copy( L, -2 );
+		lua_rawseti( L, -2, index + 1 );
+		pop_n( L, 2 );
+	}
+
 	// Calls a metafield of the given object, if existant pushes the result on top of the stack and returns true, else does nothing.
 	//
 	template<typename... Tx>
@@ -425,4 +549,251 @@ namespace ulua::stack
 		}
 		pop_n( L, n );
 	}
-};
\ No newline at end of file
+};
+
+namespace ulua
+{
+	// Scope recording the stack top on entry and restoring it on exit. Stack references constructed with the frame
+	// and function results released to it hand their slots over and skip their individual removal, anything else
+	// keeps removing itself. Nothing handed to the frame may outlive it.
+	//
+	struct stack_frame
+	{
+		lua_State* L;
+		stack::slot base;
+
+		inline explicit stack_frame( lua_State* L ) : L( L ), base( stack::top( L ) ) {}
+		stack_frame( const stack_frame& ) = delete;
+		stack_frame& operator=( const stack_frame& ) = delete;
+		inline ~stack_frame() { lua_settop( L, base ); }
+
+		// Checks if the given absolute slot is above the base of the frame.
+		//
+		ULUA_INLINE inline bool contains( lua_State* L, stack::slot i ) const { return this->L == L && i > base; }
+	};
+};
+
+namespace ulua
+{
+	// Constant string keys, interned once per state and kept alive in the per-state cache so that
+	// the accelerated lookups can go straight to the hash part without hashing the string again.
+	//
+	template<typename S>
+	struct interned_key
+	{
+		static constexpr bool is_custom_key = true;
+		static constexpr std::string_view value = { S::get(), std::size( S::data ) - 1 };
+
+		ULUA_COLD static void push_slow( lua_State* L )
+		{
+			lua_pushlstring( L, value.data(), value.size() );
+			stack::copy( L, -1 );
+			stack::set_cached<interned_key>( L );
+		}
+		ULUA_INLINE static void push( lua_State* L )
+		{
+			if ( !stack::push_cached<interned_key>( L ) ) [[unlikely]]
+				push_slow( L );
+		}
+#if ULUA_ACCEL
+		ULUA_INLINE static GCstr* ref( lua_State* L )
+		{
+			if ( cTValue* tv = stack::ref_cached<interned_key>( L ) ) [[likely]]
+				return strV( tv );
+			push_slow( L );
+			GCstr* result = strV( accel::ref( L, -1 ) );
+			stack::pop_n( L, 1 );
+			return result;
+		}
+#endif
+
+		// Table accessors, raw accesses and tables without a metatable skip the metamethod machinery.
+		//
+		template<bool Raw>
+		ULUA_INLINE static void get_field( lua_State* L, stack::slot i, std::bool_constant<Raw> )
+		{
+#if ULUA_ACCEL
+			GCstr* key = ref( L );
+			TValue* tv = accel::ref( L, i );
+			if ( tvistab( tv ) ) [[likely]]
+			{
+				GCtab* t = tabV( tv );
+				cTValue* result = lj_tab_getstr( t, key );
+				if ( Raw || !tabref( t->metatable ) || ( result && !tvisnil( result ) ) ) [[likely]]
+				{
+					if ( result )
+						copyTV( L, L->top, result );
+					else
+						setnilV( L->top );
+					incr_top( L );
+					return;
+				}
+			}
+#endif
+			i = stack::abs( L, i );
+			push( L );
+			if constexpr ( Raw )
+				lua_rawget( L, i );
+			else
+				lua_gettable( L, i );
+		}
+		template<bool Raw>
+		ULUA_INLINE static void set_field( lua_State* L, stack::slot i, std::bool_constant<Raw> )
+		{
+#if ULUA_ACCEL
+			GCstr* key = ref( L );
+			TValue* tv = accel::ref( L, i );
+			if ( tvistab( tv ) ) [[likely]]
+			{
+				GCtab* t = tabV( tv );
+				if ( Raw || !tabref( t->metatable ) ) [[likely]]
+				{
+					TValue* slot = lj_tab_setstr( L, t, key );
+					copyTV( L, slot, L->top - 1 );
+					t->nomm = 0;
+					lj_gc_anybarriert( L, t );
+					L->top--;
+					return;
+				}
+			}
+#endif
+			i = stack::abs( L, i );
+			push( L );
+			stack::copy( L, -2 );
+			if constexpr ( Raw )
+				lua_rawset( L, i );
+			else
+				lua_settable( L, i );
+			stack::pop_n( L, 1 );
+		}
+	};
+
+	template<typename S>
+	struct type_traits<interned_key<S>>
+	{
+		ULUA_INLINE static int push( lua_State* L, interned_key<S> ) { interned_key<S>::push( L ); return 1; }
+	};
+
+	// Pushes the function returned by an internal chunk, compiled once per state and keyed by the address of the code.
+	//
+	namespace detail
+	{
+		static void push_const_code( lua_State* L, const char* code )
+		{
+			lua_pushlightuserdata( L, ( void* ) &code[ 0 ] );
+			lua_rawget( L, LUA_REGISTRYINDEX );
+			if ( !stack::type_check<value_type::function>( L, stack::top_t{} ) ) [[unlikely]]
+			{
+				stack::pop_n( L, 1 );
+				luaL_loadbuffer( L, code, strlen( code ), "internal" );
+				lua_call( L, 0, 1 );
+				lua_pushlightuserdata( L, ( void* ) &code[ 0 ] );
+				stack::copy( L, -2 );
+				lua_rawset( L, LUA_REGISTRYINDEX );
+			}
+		}
+	};
+
+	// Compile time key paths, the intermediate tables are walked with raw lookups using a single stack slot
+	// and the last key is accessed raw or through the metamethods as requested. Reading a path through a
+	// missing or non-table value yields nil, writing through one raises an error.
+	//
+	namespace detail
+	{
+		template<size_t N>
+		struct fixed_string
+		{
+			char value[ N ] = {};
+			inline constexpr fixed_string( const char( &str )[ N ] ) { std::copy_n( str, N, value ); }
+		};
+
+		template<fixed_string S, typename Seq = std::make_index_sequence<std::size( S.value ) - 1>>
+		struct fixed_key;
+		template<fixed_string S, size_t... I>
+		struct fixed_key<S, std::index_sequence<I...>> { using type = interned_key<const_string<char, S.value[ I ]...>>; };
+		template<fixed_string S>
+		using fixed_key_t = typename fixed_key<S>::type;
+
+		// Checks whether the given key strings are pairwise distinct.
+		//
+		template<fixed_string... Sx>        struct distinct_keys { static constexpr bool value = true; };
+		template<fixed_string S, fixed_string... Sx> struct distinct_keys<S, Sx...> { static constexpr bool value = ( !std::is_same_v<fixed_key_t<S>, fixed_key_t<Sx>> && ... ) && distinct_keys<Sx...>::value; };
+		template<fixed_string... Sx>
+		static constexpr bool distinct_keys_v = distinct_keys<Sx...>::value;
+	};
+	template<detail::fixed_string... Keys>
+	struct key_path
+	{
+		static_assert( sizeof...( Keys ) != 0, "Empty key path." );
+		static constexpr bool is_custom_key = true;
+		static constexpr size_t length = sizeof...( Keys );
+
+		// Pushes the table holding the last key, or returns false if the walk hits a non-table value.
+		//
+		ULUA_INLINE static bool push_parent( lua_State* L, stack::slot i )
+		{
+#if ULUA_ACCEL
+			GCstr* keys[] = { detail::fixed_key_t<Keys>::ref( L )... };
+			cTValue* tv = accel::ref( L, i );
+			for ( size_t n = 0; n != length - 1; n++ )
+			{
+				if ( !tvistab( tv ) ) [[unlikely]]
+					return false;
+				tv = lj_tab_getstr( tabV( tv ), keys[ n ] );
+				if ( !tv ) [[unlikely]]
+					return false;
+			}
+			if ( !tvistab( tv ) ) [[unlikely]]
+				return false;
+			copyTV( L, L->top, tv );
+			incr_top( L );
+			return true;
+#else
+			stack::copy( L, i );
+			bool valid = true;
+			detail::enum_indices<length - 1>( [ & ] <size_t N> ( const_tag<N> )
+			{
+				if ( valid && ( valid = stack::type_check<value_type::table>( L, stack::top_t{} ) ) )
+				{
+					stack::get_field( L, -1, detail::fixed_key_t<detail::nth_parameter_t<N, const_tag<Keys>...>::value>{}, raw_t{} );
+					lua_replace( L, -2 );
+				}
+			} );
+			if ( !valid || !stack::type_check<value_type::table>( L, stack::top_t{} ) ) [[unlikely]]
+			{
+				stack::pop_n( L, 1 );
+				return false;
+			}
+			return true;
+#endif
+		}
+
+		using last_key = detail::fixed_key_t<detail::nth_parameter_t<length - 1, const_tag<Keys>...>::value>;
+
+		template<bool Raw>
+		ULUA_INLINE static void get_field( lua_State* L, stack::slot i, std::bool_constant<Raw> )
+		{
+			if ( !push_parent( L, i ) ) [[unlikely]]
+			{
+				lua_pushnil( L );
+				return;
+			}
+			last_key::get_field( L, -1, std::bool_constant<Raw>{} );
+			lua_replace( L, -2 );
+		}
+		template<bool Raw>
+		ULUA_INLINE static void set_field( lua_State* L, stack::slot i, std::bool_constant<Raw> )
+		{
+			if ( !push_parent( L, i ) ) [[unlikely]]
+				error( L, "indexing a non-table value in key path" );
+			lua_insert( L, -2 );
+			last_key::set_field( L, -2, std::bool_constant<Raw>{} );
+			stack::pop_n( L, 1 );
+		}
+	};
+	template<detail::fixed_string... Keys>
+	inline constexpr key_path<Keys...> path = {};
+};
+
+template<typename T, T... V>
+static constexpr auto operator""_k() { return ulua::interned_key<ulua::detail::const_string<T, V...>>{}; }
@@ -4,6 +4,7 @@
 #include "reference.hpp"
 #include "function.hpp"
 #include "table.hpp"
+#include "extension.hpp"
 
 namespace ulua
 {
@@ -20,8 +21,8 @@ namespace ulua
 		static constexpr library_descriptor io =      { &luaopen_io,       "io" };
 		static constexpr library_descriptor os =      { &luaopen_os,       "os" };
 		static constexpr library_descriptor debug =   { &luaopen_debug,    "debug" };
-		static constexpr library_descriptor bit =     { &luaopen_bit,      "bit32" };
 #if ULUA_JIT
+		static constexpr library_descriptor bit =     { &luaopen_bit,      "bit32" };
 		static constexpr library_descriptor ffi =     { &luaopen_ffi,      "ffi" };
 		static constexpr library_descriptor jit =     { &luaopen_jit,      "jit" };
 #endif
@@ -119,10 +120,16 @@ namespace ulua
 			return T{ L, stack::top_t{} };
 		}
 
+		// Gets the per-state extension of the given type, created on first use.
+		//
+		template<typename T>
+		inline T& get_extension() const { return extension<T>::get( L ); }
+
 		// References globals.
 		//
 		inline stack_table globals() { return stack_table{ stack_reference{ L, LUA_GLOBALSINDEX } }; }
 		template<typename Key> inline auto operator[]( Key&& key ) { return detail::make_table_proxy<true>( L, LUA_GLOBALSINDEX, false, std::forward<Key>( key ) ); }
+		template<typename F = function> inline global_lookup<F> lookup_global( std::string_view name ) { return { L, name }; }
 
 		// Opens the given libraries.
 		//
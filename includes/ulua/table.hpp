@@ -106,6 +106,375 @@ namespace ulua
 		inline pointer operator->() const { return &at; }
 	};
 
+	// Table iterators, the key and the value are kept on the stack above the table and converted
+	// in place through the type traits, so that the iteration does not create any references.
+	//
+	template<typename K, typename V>
+	struct pairs_iterator
+	{
+		// Define iterator traits.
+		//
+		using iterator_category = std::input_iterator_tag;
+		using difference_type =   stack::slot;
+		using value_type =        std::pair<K, V>;
+		using reference =         const value_type&;
+		using pointer =           const value_type*;
+
+		stack_reference table = {};
+		std::optional<value_type> at = {};
+
+		inline pairs_iterator( stack_reference _table ) : table( std::move( _table ) )
+		{
+			stack::push( table.state(), nil );
+			pop_state();
+		}
+		inline pairs_iterator() {}
+		pairs_iterator( const pairs_iterator& ) = delete;
+		pairs_iterator& operator=( const pairs_iterator& ) = delete;
+		inline ~pairs_iterator()
+		{
+			if ( at )
+			{
+				at.reset();
+				stack::pop_n( table.state(), 2 );
+			}
+		}
+
+		ULUA_COLD static const char* key_type_name()
+		{
+			detail::type_set types = detail::accepted_types_of<type_traits<K>> & ~detail::nil_types;
+			return types ? type_name( ulua::value_type( std::countr_zero( types ) - 1 ) ) : "nil";
+		}
+		inline void pop_state()
+		{
+			lua_State* L = table.state();
+			if ( lua_next( L, table.slot() ) )
+			{
+				stack::slot top = stack::top( L );
+
+				// Lenient conversions such as number to string would replace the key in place and break
+				// lua_next, so the key is checked before it is converted.
+				//
+				int idx = top - 1;
+				if ( !type_traits<K>::check( L, idx ) ) [[unlikely]]
+					type_error( L, top - 1, key_type_name() );
+				at.emplace( stack::get<K>( L, top - 1 ), stack::get<V>( L, top ) );
+			}
+		}
+		inline pairs_iterator& operator++()
+		{
+			at.reset();
+			stack::pop_n( table.state(), 1 );
+			pop_state();
+			return *this;
+		}
+		inline bool operator==( const pairs_iterator& other ) const { return at.has_value() == other.at.has_value(); }
+		inline bool operator!=( const pairs_iterator& other ) const { return at.has_value() != other.at.has_value(); }
+		inline reference operator*() const { return *at; }
+		inline pointer operator->() const { return &*at; }
+	};
+	template<typename V>
+	struct ipairs_iterator
+	{
+		// Define iterator traits.
+		//
+		using iterator_category = std::input_iterator_tag;
+		using difference_type =   stack::slot;
+		using value_type =        std::pair<int, V>;
+		using reference =         const value_type&;
+		using pointer =           const value_type*;
+
+		stack_reference table = {};
+		int index = 0;
+		std::optional<value_type> at = {};
+
+		inline ipairs_iterator( stack_reference _table ) : table( std::move( _table ) ) { pop_state(); }
+		inline ipairs_iterator() {}
+		ipairs_iterator( const ipairs_iterator& ) = delete;
+		ipairs_iterator& operator=( const ipairs_iterator& ) = delete;
+		inline ~ipairs_iterator()
+		{
+			if ( at )
+			{
+				at.reset();
+				stack::pop_n( table.state(), 1 );
+			}
+		}
+
+		inline void pop_state()
+		{
+			lua_State* L = table.state();
+			stack::get_field( L, table.slot(), ++index, raw_t{} );
+			if ( stack::type_check<ulua::value_type::nil>( L, stack::top_t{} ) )
+				stack::pop_n( L, 1 );
+			else
+				at.emplace( index, stack::get<V>( L, stack::top( L ) ) );
+		}
+		inline ipairs_iterator& operator++()
+		{
+			at.reset();
+			stack::pop_n( table.state(), 1 );
+			pop_state();
+			return *this;
+		}
+		inline bool operator==( const ipairs_iterator& other ) const { return at.has_value() == other.at.has_value(); }
+		inline bool operator!=( const ipairs_iterator& other ) const { return at.has_value() != other.at.has_value(); }
+		inline reference operator*() const { return *at; }
+		inline pointer operator->() const { return &*at; }
+	};
+
+	// Range over a table pushed for the duration of the iteration.
+	//
+	template<typename It>
+	struct table_range
+	{
+		stack_reference table;
+		inline It begin() const { return It{ stack_reference{ table.state(), table.slot(), weak_t{} } }; }
+		inline It end() const { return {}; }
+	};
+
+	// Typed view of the array elements of a table, reads the array part in place when accelerated and
+	// converts the elements in chunks otherwise. The view holds the stack slot or its own registry reference
+	// to the table, so stack tables must stay on the stack while it is used, and the table must not be resized.
+	//
+	template<typename T, Reference Ref>
+	struct array_view
+	{
+		static_assert( std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "Array views are only available for numbers." );
+		static constexpr size_t chunk_size = 64;
+
+		// Random access iterator.
+		//
+		struct iterator
+		{
+			using iterator_category = std::random_access_iterator_tag;
+			using difference_type =   ptrdiff_t;
+			using value_type =        T;
+			using reference =         T;
+
+			const array_view* view = nullptr;
+			size_t index = 0;
+
+			inline T operator*() const { return ( *view )[ index ]; }
+			inline T operator[]( difference_type n ) const { return ( *view )[ index + n ]; }
+			inline iterator& operator++() { index++; return *this; }
+			inline iterator& operator--() { index--; return *this; }
+			inline iterator operator++( int ) { auto r = *this; index++; return r; }
+			inline iterator operator--( int ) { auto r = *this; index--; return r; }
+			inline iterator& operator+=( difference_type n ) { index += n; return *this; }
+			inline iterator& operator-=( difference_type n ) { index -= n; return *this; }
+			inline iterator operator+( difference_type n ) const { return { view, index + n }; }
+			inline iterator operator-( difference_type n ) const { return { view, index - n }; }
+			friend inline iterator operator+( difference_type n, const iterator& it ) { return it + n; }
+			inline difference_type operator-( const iterator& other ) const { return difference_type( index ) - difference_type( other.index ); }
+			inline bool operator==( const iterator& other ) const { return index == other.index; }
+			inline auto operator<=>( const iterator& other ) const { return index <=> other.index; }
+		};
+
+		lua_State* L = nullptr;
+		size_t count = 0;
+		Ref table = {};
+
+		inline static Ref hold( const Ref& ref )
+		{
+			if constexpr ( Ref::is_direct )
+			{
+				return Ref{ ref.state(), ref.slot(), weak_t{} };
+			}
+			else
+			{
+				Ref result = {};
+				result.assign( ref );
+				return result;
+			}
+		}
+		ULUA_COLD void bounds_error [[noreturn]] ( size_t i ) const
+		{
+			error( L, "array index %d is out of bounds", int( i + 1 ) );
+		}
+#if ULUA_ACCEL
+		GCtab* array = nullptr;
+		cTValue* slots = nullptr;
+		size_t slot_count = 0;
+
+		inline array_view( const Ref& ref ) : L( ref.state() ), table( hold( ref ) )
+		{
+			if constexpr ( Ref::is_direct )
+			{
+				array = tabV( accel::ref( L, table.slot() ) );
+			}
+			else
+			{
+				table.push();
+				array = tabV( accel::ref( L, -1 ) );
+				stack::pop_n( L, 1 );
+			}
+			count = lj_tab_len( array );
+			slots = tvref( array->array ) + 1;
+			slot_count = array->asize ? array->asize - 1 : 0;
+		}
+
+		// Elements past the array part live in the hash part.
+		//
+		ULUA_COLD cTValue* lookup_hash( size_t i ) const
+		{
+			if ( i >= count )
+				bounds_error( i );
+			cTValue* tv = lj_tab_getint( array, int32_t( i + 1 ) );
+			return tv ? tv : niltv( L );
+		}
+		inline T operator[]( size_t i ) const
+		{
+			cTValue* tv = i < slot_count ? &slots[ i ] : lookup_hash( i );
+			if ( !tvisnumber( tv ) ) [[unlikely]]
+				error( L, "array element %d is not a number", int( i + 1 ) );
+			if constexpr ( std::is_integral_v<T> )
+				return detail::integer_cast<T>( numberVnum( tv ) );
+			else
+				return T( numberVnum( tv ) );
+		}
+#else
+		mutable size_t chunk_base = 0;
+		mutable size_t chunk_end = 0;
+		mutable std::array<T, chunk_size> chunk = {};
+
+		inline array_view( const Ref& ref ) : L( ref.state() ), table( hold( ref ) )
+		{
+			if constexpr ( Ref::is_direct )
+			{
+				count = stack::length( L, table.slot() );
+			}
+			else
+			{
+				table.push();
+				count = stack::length( L, stack::top_t{} );
+				stack::pop_n( L, 1 );
+			}
+		}
+
+		ULUA_COLD void fill( size_t i ) const
+		{
+			if ( i >= count )
+				bounds_error( i );
+			chunk_base = i - ( i % chunk_size );
+			size_t n = std::min( chunk_size, count - chunk_base );
+			chunk_end = chunk_base + n;
+
+			stack::slot slot;
+			if constexpr ( Ref::is_direct )
+			{
+				slot = table.slot();
+			}
+			else
+			{
+				table.push();
+				slot = stack::top( L );
+			}
+			for ( size_t j = 0; j != n; j++ )
+			{
+				stack::get_field( L, slot, int( chunk_base + j + 1 ), raw_t{} );
+				chunk[ j ] = stack::pop<T>( L );
+			}
+			if constexpr ( !Ref::is_direct )
+				stack::pop_n( L, 1 );
+		}
+		inline T operator[]( size_t i ) const
+		{
+			if ( i < chunk_base || i >= chunk_end ) [[unlikely]]
+				fill( i );
+			return chunk[ i - chunk_base ];
+		}
+#endif
+
+		inline size_t size() const { return count; }
+		inline bool empty() const { return count == 0; }
+		inline iterator begin() const { return { this, 0 }; }
+		inline iterator end() const { return { this, count }; }
+	};
+
+	// Table shapes, instances of records with the same key set are duplicated from a prototype created
+	// once per state and filled positionally, so that the hash part is never grown or rehashed.
+	//
+	template<typename Shape, typename Tuple>
+	struct shaped_table
+	{
+		Tuple values;
+	};
+	template<detail::fixed_string... Keys>
+	struct table_shape
+	{
+		static_assert( detail::distinct_keys_v<Keys...>, "Duplicate key in table shape." );
+		static constexpr size_t length = sizeof...( Keys );
+
+		// Prototype with every key mapped to false.
+		//
+		ULUA_COLD static void push_prototype_slow( lua_State* L )
+		{
+			stack::create_table( L, reserve_records{ int( length ) } );
+			( ( stack::push( L, false ), detail::fixed_key_t<Keys>::set_field( L, -2, raw_t{} ) ), ... );
+			stack::copy( L, -1 );
+			stack::set_cached<table_shape>( L );
+		}
+#if ULUA_ACCEL
+		ULUA_INLINE static GCtab* prototype( lua_State* L )
+		{
+			if ( cTValue* tv = stack::ref_cached<table_shape>( L ) ) [[likely]]
+				return tabV( tv );
+			push_prototype_slow( L );
+			GCtab* result = tabV( accel::ref( L, -1 ) );
+			stack::pop_n( L, 1 );
+			return result;
+		}
+		template<typename T>
+		ULUA_INLINE static void fill( lua_State* L, GCtab* t, GCstr* key, T&& value )
+		{
+			stack::push( L, std::forward<T>( value ) );
+			TValue* slot = ( TValue* ) lj_tab_getstr( t, key );
+			copyTV( L, slot, L->top - 1 );
+			lj_gc_anybarriert( L, t );
+			L->top--;
+		}
+#endif
+
+		// Pushes an instance with the given values.
+		//
+		template<typename... Tx> requires ( sizeof...( Tx ) == length )
+		ULUA_INLINE static int push( lua_State* L, Tx&&... values )
+		{
+#if ULUA_ACCEL
+			GCstr* keys[] = { detail::fixed_key_t<Keys>::ref( L )... };
+			GCtab* t = lj_tab_dup( L, prototype( L ) );
+			settabV( L, L->top, t );
+			incr_top( L );
+			size_t n = 0;
+			( fill( L, t, keys[ n++ ], std::forward<Tx>( values ) ), ... );
+#else
+			stack::create_table( L, reserve_records{ int( length ) } );
+			( ( stack::push( L, std::forward<Tx>( values ) ), detail::fixed_key_t<Keys>::set_field( L, -2, raw_t{} ) ), ... );
+#endif
+			return 1;
+		}
+		template<typename Tuple>
+		ULUA_INLINE static int push_tuple( lua_State* L, Tuple&& values )
+		{
+			return std::apply( [ & ] <typename... Tx> ( Tx&&... values ) { return push( L, std::forward<Tx>( values )... ); }, std::forward<Tuple>( values ) );
+		}
+
+		// Creates a pushable instance, for use as a return value.
+		//
+		template<typename... Tx> requires ( sizeof...( Tx ) == length )
+		static constexpr auto make( Tx&&... values )
+		{
+			return shaped_table<table_shape, std::tuple<std::decay_t<Tx>...>>{ { std::forward<Tx>( values )... } };
+		}
+	};
+	template<typename Shape, typename Tuple>
+	struct type_traits<shaped_table<Shape, Tuple>>
+	{
+		template<typename V>
+		ULUA_INLINE static int push( lua_State* L, V&& value ) { return Shape::push_tuple( L, std::forward<V>( value ).values ); }
+	};
+
 	// Create tag.
 	//
 	struct create : reserve_table { inline constexpr create( reserve_table rsvd = {} ) : reserve_table( rsvd ) {} };
@@ -115,6 +484,8 @@ namespace ulua
 	template<Reference Ref>
 	struct basic_table : Ref, detail::lazy_indexable<basic_table<Ref>>
 	{
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::table>;
+		static constexpr detail::type_set exact_types =    accepted_types;
 		ULUA_INLINE inline static bool check( lua_State* L, int& slot ) 
 		{
 			return stack::type_check<value_type::table>( L, slot++ );
@@ -138,8 +509,29 @@ namespace ulua
 			Ref::swap( ref );
 		}
 
-		inline iterator begin() const { return stack_reference{ *this }; }
+		// References the table on the stack, pushing it if necessary.
+		//
+		inline stack_reference stack_ref() const
+		{
+			if constexpr ( Ref::is_direct )
+				return stack_reference{ this->state(), this->slot(), weak_t{} };
+			else
+				return stack_reference{ static_cast<const Ref&>( *this ) };
+		}
+
+		// Iteration.
+		//
+		inline iterator begin() const { return iterator{ stack_ref() }; }
 		inline iterator end() const { return {}; }
+		template<typename K = stack_object, typename V = stack_object>
+		inline table_range<pairs_iterator<K, V>> pairs() const { return { stack_ref() }; }
+		template<typename V = stack_object>
+		inline table_range<ipairs_iterator<V>> ipairs() const { return { stack_ref() }; }
+
+		// Typed view of the array elements.
+		//
+		template<typename T>
+		inline ulua::array_view<T, Ref> array_view() const { return { *this }; }
 	};
 	using table =       basic_table<registry_reference>;
 	using stack_table = basic_table<stack_reference>;
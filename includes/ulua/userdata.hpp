@@ -15,8 +15,11 @@ namespace ulua
 	struct user_traits : nil_t {};
 	template<typename T> requires requires { typename T::lua_traits; }
 	struct user_traits<T> : T::lua_traits {};
+	struct table_t {};
 	template<typename T>
-	concept UserType = ( !std::is_base_of_v<nil_t, user_traits<T>> );
+	concept UserTableType = std::is_base_of_v<table_t, user_traits<T>>;
+	template<typename T>
+	concept UserType = ( !std::is_base_of_v<nil_t, user_traits<T>> ) && !UserTableType<T>;
 	template<typename T>
 	struct userdata_metatable;
 
@@ -180,6 +183,8 @@ namespace ulua
 	template<typename T>
 	struct type_traits<userdata_wrapper<T>>
 	{
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::userdata>;
+		static constexpr detail::type_set exact_types =    0;
 		// No pusher.
 		ULUA_INLINE inline static bool check( lua_State* L, int& idx )
 		{ 
@@ -218,6 +223,8 @@ namespace ulua
 		{
 			return emplace( L, std::forward<V>( value ) );
 		}
+		static constexpr detail::type_set accepted_types = detail::accepted_types_of<type_traits<userdata_wrapper<T>>>;
+		static constexpr detail::type_set exact_types =    0;
 		ULUA_INLINE inline static bool check( lua_State* L, int& idx )
 		{
 			return type_traits<userdata_wrapper<T>>::check( L, idx );
@@ -250,6 +257,8 @@ namespace ulua
 			T& result = user_type_traits<T>::get( L, idx );
 			return &result;
 		}
+		static constexpr detail::type_set accepted_types = user_type_traits<T>::accepted_types;
+		static constexpr detail::type_set exact_types =    0;
 		ULUA_INLINE inline static bool check( lua_State* L, int& idx ) { return user_type_traits<T>::check( L, idx ); }
 	};
 	template<UserType T> struct type_traits<T&&> :                                        user_type_traits<T&&> {};
@@ -261,4 +270,88 @@ namespace ulua
 	template<UserType T> struct type_traits<const T*> :                                   user_type_traits<const T*> {};
 	template<UserType T> struct type_traits<std::reference_wrapper<T>> :                  user_type_traits<T> {};
 	template<UserType T> struct type_traits<std::reference_wrapper<const T>> :            user_type_traits<const T> {};
-};
\ No newline at end of file
+
+	// User types marshalled by value as tables, the data members declared in the fields are
+	// written with raw sets into a presized table and read back in a single traversal.
+	//
+	namespace detail
+	{
+		template<typename T, size_t I>
+		struct table_field
+		{
+			using descriptor = std::decay_t<std::tuple_element_t<I, std::decay_t<decltype( ulua::userdata_fields<T> )>>>;
+			static_assert( requires { descriptor::getter_type::field; }, "Only data members can be marshalled as table fields." );
+
+			static constexpr auto field = descriptor::getter_type::field;
+			using type = std::remove_cvref_t<decltype( std::declval<T&>().*field )>;
+			static constexpr std::string_view name = std::get<I>( ulua::userdata_fields<T> ).name;
+
+			template<size_t... J>
+			static interned_key<const_string<char, name[ J ]...>> make_key( std::index_sequence<J...> );
+			using key = decltype( make_key( std::make_index_sequence<name.size()>{} ) );
+		};
+	};
+	template<UserTableType T>
+	struct type_traits<T>
+	{
+		static constexpr size_t field_count = std::tuple_size_v<std::decay_t<decltype( userdata_fields<T> )>>;
+		static constexpr auto field_names = std::apply( [ ] ( const auto&... fields )
+		{
+			return std::array<std::string_view, field_count>{ std::string_view{ fields.name }... };
+		}, userdata_fields<T> );
+		static constexpr detail::perfect_hash<field_count> field_hash{ field_names };
+
+		ULUA_INLINE static int push( lua_State* L, const T& value )
+		{
+			stack::create_table( L, reserve_records{ int( field_count ) } );
+			detail::enum_indices<field_count>( [ & ] <size_t I> ( const_tag<I> )
+			{
+				using F = detail::table_field<T, I>;
+				stack::push( L, value.*F::field );
+				F::key::set_field( L, -2, raw_t{} );
+			} );
+			return 1;
+		}
+		static constexpr detail::type_set accepted_types = detail::type_bits<value_type::table>;
+		static constexpr detail::type_set exact_types =    accepted_types;
+		ULUA_INLINE static bool check( lua_State* L, int& idx )
+		{
+			return stack::type_check<value_type::table>( L, idx++ );
+		}
+		ULUA_INLINE static T get( lua_State* L, int& idx )
+		{
+			int i = stack::abs( L, idx++ );
+			if ( !stack::type_check<value_type::table>( L, i ) ) [[unlikely]]
+				type_error( L, i, userdata_name<T>().data() );
+
+			T result = {};
+			if constexpr ( field_count != 0 )
+			{
+				stack::push( L, nil );
+				while ( lua_next( L, i ) )
+				{
+					if ( stack::type_check<value_type::string>( L, -2 ) )
+					{
+						int k = stack::top( L ) - 1;
+						std::string_view key = type_traits<std::string_view>::get( L, k );
+						int n = field_hash.find( key );
+						if ( n >= 0 )
+						{
+							detail::visit_index<field_count>( size_t( n ), [ & ] <size_t I> ( const_tag<I> ) ULUA_INLINE -> bool
+							{
+								using F = detail::table_field<T, I>;
+								constexpr std::string_view name = field_names[ I ];
+								if ( key.size() != name.size() || !detail::const_eq<name.size()>( key.data(), name.data() ) )
+									return false;
+								result.*F::field = stack::get<typename F::type>( L, stack::top( L ) );
+								return true;
+							} );
+						}
+					}
+					stack::pop_n( L, 1 );
+				}
+			}
+			return result;
+		}
+	};
+};
@@ -51,20 +51,6 @@ namespace ulua
 		template<typename T, typename O> concept Powable = requires( const T & v, const O & v2 ) { pow( v, v2 ); };
 		template<typename T, typename O> concept Xorable = requires( const T& v, const O& v2 ) { v ^ v2; };
 
-		static void push_const_code( lua_State* L, const char* code )
-		{
-			lua_pushlightuserdata( L, ( void* ) &code[ 0 ] );
-			lua_rawget( L, LUA_REGISTRYINDEX );
-			if ( !stack::type_check<value_type::function>( L, stack::top_t{} ) ) [[unlikely]]
-			{
-				stack::pop_n( L, 1 );
-				luaL_loadbuffer( L, code, strlen( code ), "internal" );
-				lua_call( L, 0, 1 );
-				lua_pushlightuserdata( L, ( void* ) &code[ 0 ] );
-				stack::copy( L, -2 );
-				lua_rawset( L, LUA_REGISTRYINDEX );
-			}
-		}
 		template<typename... Tx>
 		static void run_through( lua_State* L, const char* code, Tx&&... args )
 		{
@@ -103,51 +89,128 @@ namespace ulua
 		const char* code;
 	};
 
+	namespace detail
+	{
+		// Stateless accessors that the native field dispatcher can default construct and invoke directly instead of
+		// through a closure, uses the same test as the stateless lambda path of push_closure.
+		//
+		template<typename F>
+		concept NativeAccessor = Invocable<F> && function_traits<F>::is_lambda && std::is_default_constructible_v<F> && std::is_trivially_destructible_v<F> && sizeof( F ) == sizeof( std::monostate );
+
+		// Accessors of the bound data members.
+		//
+		template<auto Field>
+		struct field_getter
+		{
+			using class_type = member_field_class_t<Field>;
+			static constexpr auto field = Field;
+			inline decltype( auto ) operator()( lua_State*, class_type* p ) const { return p->*Field; }
+		};
+		template<auto Field>
+		struct field_setter
+		{
+			using class_type = member_field_class_t<Field>;
+			static constexpr auto field = Field;
+			inline void operator()( lua_State*, class_type* p, const stack_object& value ) const { p->*Field = ( std::decay_t<decltype( p->*Field )> ) value; }
+		};
+	};
+
 	template<typename G, typename S>
 	struct member_descriptor
 	{
+		using getter_type = std::decay_t<G>;
+		using setter_type = std::decay_t<S>;
+		static constexpr bool is_method = std::is_base_of_v<constant_getter_tag, getter_type>;
+
 		G getter;
 		S setter;
 		const char* name;
 		inline constexpr member_descriptor( const char* name, G&& getter, S&& setter ) : getter( std::forward<G>( getter ) ), setter( std::forward<S>( setter ) ), name( name ) {}
 
-		inline void write_getter( stack_table& tbl ) const
+		// Writes member functions and other constants into the method table.
+		//
+		inline void write_method( stack_table& tbl ) const
+		{
+			if constexpr ( is_method )
+				tbl.at( name, raw_t{} ) = getter.value;
+		}
+
+		// Writes the values the dispatcher cannot invoke natively into the accessor table at the given index.
+		//
+		inline void write_getter( stack_table& tbl, int i ) const
 		{
-			if constexpr ( !std::is_same_v<G, nil_t> )
+			if constexpr ( std::is_same_v<bytecode_property, getter_type> )
 			{
-				if constexpr ( std::is_base_of_v<constant_getter_tag, G> )
-				{
-					detail::run_through( tbl.state(), "return function(tbl, key, value) tbl[key] = function() return value end end", tbl, name, getter.value );
-				}
-				else if constexpr ( std::is_same_v<bytecode_property, G> )
-				{
-					detail::push_const_code( tbl.state(), getter.code );
-					lua_setfield( tbl.state(), tbl.slot(), name );
-				}
-				else
-				{
-					tbl[ name ] = getter;
-				}
+				detail::push_const_code( tbl.state(), getter.code );
+				stack::set_field( tbl.state(), tbl.slot(), i, raw_t{} );
 			}
-			else
+			else if constexpr ( !is_method && !std::is_same_v<getter_type, nil_t> && !detail::NativeAccessor<getter_type> )
 			{
-				detail::run_through( tbl.state(), "return function(tbl, key, x) tbl[key] = function() error(x, 2) end end", tbl, name, "getting write-only property" );
+				tbl.at( i, raw_t{} ) = getter;
 			}
 		}
-		inline void write_setter( stack_table& tbl ) const
+		inline void write_setter( stack_table& tbl, int i ) const
 		{
-			if constexpr ( std::is_same_v<bytecode_property, S> )
+			if constexpr ( std::is_same_v<bytecode_property, setter_type> )
 			{
 				detail::push_const_code( tbl.state(), setter.code );
-				lua_setfield( tbl.state(), tbl.slot(), name );
+				stack::set_field( tbl.state(), tbl.slot(), i, raw_t{} );
+			}
+			else if constexpr ( !std::is_same_v<setter_type, nil_t> && !detail::NativeAccessor<setter_type> )
+			{
+				tbl.at( i, raw_t{} ) = setter;
+			}
+		}
+
+		// Invoked by the dispatcher with the object and the key on the stack, and the accessor table as the first upvalue.
+		//
+		inline int get( lua_State* L, int i ) const
+		{
+			if constexpr ( std::is_same_v<getter_type, nil_t> )
+			{
+				error( L, "getting write-only property" );
+			}
+			else if constexpr ( is_method )
+			{
+				// Resolved by the method table lookup, only reached if the constant is nil.
+				//
+				return 0;
+			}
+			else if constexpr ( detail::NativeAccessor<getter_type> )
+			{
+				using Traits = detail::function_traits<getter_type>;
+				stack::set_top( L, 1 );
+				getter_type fn{};
+				return detail::apply_closure<typename Traits::return_type, typename Traits::arguments>( L, fn );
+			}
+			else
+			{
+				stack::set_top( L, 1 );
+				stack::get_field( L, lua_upvalueindex( 1 ), i, raw_t{} );
+				stack::copy( L, 1 );
+				lua_call( L, 1, 1 );
+				return 1;
+			}
+		}
+		inline void set( lua_State* L, int i ) const
+		{
+			if constexpr ( std::is_same_v<setter_type, nil_t> )
+			{
+				error( L, "setting read-only property" );
 			}
-			else if constexpr ( !std::is_same_v<S, nil_t> )
+			else if constexpr ( detail::NativeAccessor<setter_type> )
 			{
-				tbl[ name ] = setter;
+				using Traits = detail::function_traits<setter_type>;
+				stack::remove( L, 2 );
+				setter_type fn{};
+				detail::apply_closure<typename Traits::return_type, typename Traits::arguments>( L, fn );
 			}
 			else
 			{
-				detail::run_through( tbl.state(), "return function(tbl, key, x) tbl[key] = function() error(x, 2) end end", tbl, name, "setting read-only property" );
+				stack::get_field( L, lua_upvalueindex( 1 ), i, raw_t{} );
+				stack::copy( L, 1 );
+				stack::copy( L, 3 );
+				lua_call( L, 2, 0 );
 			}
 		}
 	};
@@ -175,11 +238,10 @@ namespace ulua
 		}
 		else if constexpr ( detail::is_member_field_v<decltype( Field )> )
 		{
-			using T = detail::member_field_class_t<Field>;
 			return member_descriptor{
 				name,
-				[ ] ( lua_State*, T* p ) -> decltype( auto ) { return p->*Field; },
-				[ ] ( lua_State*, T* p, const stack_object& value ) { p->*Field = (std::decay_t<decltype( p->*Field )>) value; }
+				detail::field_getter<Field>{},
+				detail::field_setter<Field>{}
 			};
 		}
 		else
@@ -190,10 +252,9 @@ namespace ulua
 	template<auto Field>
 	static constexpr auto member( const char* name, readonly_t )
 	{
-		using T = detail::member_field_class_t<Field>;
 		return member_descriptor{
 			name,
-			[ ] ( lua_State*, T* p ) -> decltype( auto ) { return p->*Field; },
+			detail::field_getter<Field>{},
 			nil
 		};
 	}
@@ -274,21 +335,148 @@ namespace ulua
 		}
 
 
+		// Native field dispatch, the key is matched against the field names with a compile time perfect hash.
+		//
+		static constexpr size_t field_count = std::tuple_size_v<std::decay_t<decltype( userdata_fields<T> )>>;
+		static constexpr auto field_names = std::apply( [ ] ( const auto&... fields )
+		{
+			return std::array<std::string_view, field_count>{ std::string_view{ fields.name }... };
+		}, userdata_fields<T> );
+		static constexpr detail::perfect_hash<field_count> field_hash{ field_names };
+		static constexpr size_t method_count = std::apply( [ ] <typename... F> ( const F&... )
+		{
+			return ( size_t( F::is_method ) + ... + 0 );
+		}, userdata_fields<T> );
+
+		// Looks up the key in the method table, pushes the value and returns true if it exists.
+		//
+		ULUA_INLINE inline static bool push_method( lua_State* L )
+		{
+			if constexpr ( method_count != 0 )
+			{
+#if ULUA_ACCEL
+				cTValue* key = accel::ref( L, 2 );
+				if ( !tvisstr( key ) )
+					return false;
+				cTValue* tv = lj_tab_getstr( tabV( accel::ref( L, lua_upvalueindex( 3 ) ) ), strV( key ) );
+				if ( !tv || tvisnil( tv ) )
+					return false;
+				copyTV( L, L->top, tv );
+				incr_top( L );
+				return true;
+#else
+				stack::copy( L, 2 );
+				lua_rawget( L, lua_upvalueindex( 3 ) );
+				if ( !stack::type_check<value_type::nil>( L, -1 ) )
+					return true;
+				stack::pop_n( L, 1 );
+#endif
+			}
+			return false;
+		}
+
+		template<typename F>
+		ULUA_INLINE inline static bool visit_field( lua_State* L, F&& fn )
+		{
+			if constexpr ( field_count != 0 )
+			{
+				int i = 2;
+				if ( !stack::type_check<value_type::string>( L, i ) )
+					return false;
+				std::string_view key = type_traits<std::string_view>::get( L, i );
+				int n = field_hash.find( key );
+				if ( n < 0 )
+					return false;
+
+				return detail::visit_index<field_count>( size_t( n ), [ & ] <size_t I> ( const_tag<I> ) ULUA_INLINE -> bool
+				{
+					constexpr std::string_view name = field_names[ I ];
+					if ( key.size() != name.size() || !detail::const_eq<name.size()>( key.data(), name.data() ) )
+						return false;
+					fn( std::get<I>( userdata_fields<T> ), int( I + 1 ) );
+					return true;
+				} );
+			}
+			return false;
+		}
+		static int index_dispatch( lua_State* L )
+		{
+			if ( push_method( L ) )
+				return 1;
+
+			int result = 0;
+			if ( visit_field( L, [ & ] ( const auto& field, int i ) { result = field.get( L, i ); } ) )
+				return result;
+
+			// Fall back to the original __index.
+			//
+			switch ( stack::type( L, lua_upvalueindex( 2 ) ) )
+			{
+				case value_type::function:
+					stack::copy( L, lua_upvalueindex( 2 ) );
+					stack::copy( L, 1 );
+					stack::copy( L, 2 );
+					lua_call( L, 2, 1 );
+					return 1;
+				case value_type::nil:
+					return 0;
+				default:
+					stack::copy( L, lua_upvalueindex( 2 ) );
+					stack::copy( L, 2 );
+					lua_gettable( L, -2 );
+					return 1;
+			}
+		}
+		static int newindex_dispatch( lua_State* L )
+		{
+			if ( visit_field( L, [ & ] ( const auto& field, int i ) { field.set( L, i ); } ) )
+				return 0;
+
+			// Fall back to the original __newindex.
+			//
+			switch ( stack::type( L, lua_upvalueindex( 2 ) ) )
+			{
+				case value_type::function:
+					stack::copy( L, lua_upvalueindex( 2 ) );
+					stack::copy( L, 1 );
+					stack::copy( L, 2 );
+					stack::copy( L, 3 );
+					lua_call( L, 3, 0 );
+					return 0;
+				case value_type::nil:
+					error( L, "setting undefined property" );
+				default:
+					stack::copy( L, lua_upvalueindex( 2 ) );
+					stack::copy( L, 2 );
+					stack::copy( L, 3 );
+					lua_settable( L, -3 );
+					return 0;
+			}
+		}
+
+		// Replaces __index and __newindex with the dispatchers, the accessor table and the original value as upvalues,
+		// followed by the method table for __index.
+		//
 		static void adjust_index( lua_State* L, stack_table& tbl )
 		{
-			stack::create_table( L );
-			stack_table sindex{ L, stack::top_t{} };
-			std::apply( [ & ] <typename... F> ( const F&... fields ) { ( fields.write_getter( sindex ), ... ); }, userdata_fields<T> );
-			sindex.push();
-			lua_setfield( tbl.state(), tbl.slot(), "__indexref" );
+			stack::create_table( L, reserve_array{ int( field_count ) } );
+			stack_table getters{ L, stack::top_t{}, weak_t{} };
+			detail::enum_indices<field_count>( [ & ] <size_t I> ( const_tag<I> ) { std::get<I>( userdata_fields<T> ).write_getter( getters, int( I + 1 ) ); } );
+			stack::get_field( L, tbl.slot(), meta::index );
+			stack::create_table( L, reserve_records{ int( method_count ) } );
+			stack_table methods{ L, stack::top_t{}, weak_t{} };
+			std::apply( [ & ] ( const auto&... fields ) { ( fields.write_method( methods ), ... ); }, userdata_fields<T> );
+			stack::push_closure( L, &index_dispatch, 3 );
+			stack::set_field( L, tbl.slot(), meta::index );
 		}
 		static void adjust_newindex( lua_State* L, stack_table& tbl )
 		{
-			stack::create_table( L );
-			stack_table sindex{ L, stack::top_t{} };
-			std::apply( [ & ] <typename... F> ( const F&... fields ) { ( fields.write_setter( sindex ), ... ); }, userdata_fields<T> );
-			sindex.push();
-			lua_setfield( tbl.state(), tbl.slot(), "__newindexref" );
+			stack::create_table( L, reserve_array{ int( field_count ) } );
+			stack_table setters{ L, stack::top_t{}, weak_t{} };
+			detail::enum_indices<field_count>( [ & ] <size_t I> ( const_tag<I> ) { std::get<I>( userdata_fields<T> ).write_setter( setters, int( I + 1 ) ); } );
+			stack::get_field( L, tbl.slot(), meta::newindex );
+			stack::push_closure( L, &newindex_dispatch, 2 );
+			stack::set_field( L, tbl.slot(), meta::newindex );
 		}
 
 		// String conversation of the object.
@@ -403,68 +591,6 @@ namespace ulua
 			adjust_index( L, metatable );
 			adjust_newindex( L, metatable );
 
-			detail::run_through( L, R"(
-return function(table)
-	do
-		local dnindex = table.__newindex
-		local snindex = table.__newindexref
-		if type(dnindex) == "function" then
-			table.__newindex = function(self, key, value)
-				local field = snindex[key]
-				if field then
-					field(self, value)
-				else
-					dnindex(self, key, value)
-				end
-			end
-		elseif dnindex then
-			table.__newindex = function(self, key, value)
-				local field = snindex[key]
-				if field then
-					field(self, value)
-				else
-					dnindex[key] = value
-				end
-			end
-		else
-			table.__newindex = function(self, key, value)
-				local field = snindex[key]
-				return field(self, value)
-			end
-		end
-	end
-
-	do
-		local dindex = table.__index
-		local sindex = table.__indexref
-		if type(dindex) == "function" then
-			table.__index = function(self, key)
-				local field = sindex[key]
-				if field then
-					return field(self)
-				else
-					return dindex(self, key)
-				end
-			end
-		elseif dindex then
-			table.__index = function(self, key)
-				local field = sindex[key]
-				if field then
-					return field(self)
-				else
-					return dindex[key]
-				end
-			end
-		else
-			table.__index = function(self, key)
-				local field = sindex[key]
-				return field and field(self)
-			end
-		end
-	end
-end
-)", metatable );
-			
 			if ( !set_meta<meta::metatable>( metatable ) ) metatable[ meta::metatable ] = 0;
 			if ( !set_meta<meta::tostring>( metatable ) )  metatable[ meta::tostring ] = constant<&tostring>();
 			if ( !set_meta<meta::eq>( metatable ) )        metatable[ meta::eq ] = constant<&eq>();
@@ -777,12 +903,19 @@ end
 			}
 		}
 
-		// Pushes the metatable on stack.
+		// Pushes the metatable on stack, the named registry entry is only used on the first push per state.
 		//
-		inline static void push( lua_State* L )
+		ULUA_COLD static void push_slow( lua_State* L )
 		{
-			if ( stack::create_metatable( L, userdata_mt_name<T>().data() ) ) [[unlikely]]
+			if ( stack::create_metatable( L, userdata_mt_name<T>().data() ) )
 				setup( L, stack::top_t{} );
+			stack::copy( L, -1 );
+			stack::set_cached<userdata_metatable>( L );
+		}
+		ULUA_INLINE inline static void push( lua_State* L )
+		{
+			if ( !stack::push_cached<userdata_metatable>( L ) ) [[unlikely]]
+				push_slow( L );
 		}
 
 		// Gets the metatable.
@@ -0,0 +1,107 @@
+#pragma once
+#include <iterator>
+#include "common.hpp"
+#include "stack.hpp"
+#include "lazy.hpp"
+
+namespace ulua
+{
+	// View of the remaining arguments of a call when used as the last parameter of a binding, elements are
+	// converted on access and refer to the stack slots directly so the view must not outlive the call.
+	//
+	struct variadic_args
+	{
+		// Random access iterator converting the elements to the given type.
+		//
+		template<typename T>
+		struct iterator
+		{
+			using iterator_category = std::random_access_iterator_tag;
+			using difference_type =   ptrdiff_t;
+			using value_type =        detail::popped_type_t<T>;
+			using reference =         value_type;
+
+			lua_State* L = nullptr;
+			int index = 0;
+
+			inline value_type operator*() const { return stack::get<T>( L, index ); }
+			inline value_type operator[]( difference_type n ) const { return stack::get<T>( L, index + int( n ) ); }
+			inline iterator& operator++() { index++; return *this; }
+			inline iterator& operator--() { index--; return *this; }
+			inline iterator operator++( int ) { auto r = *this; index++; return r; }
+			inline iterator operator--( int ) { auto r = *this; index--; return r; }
+			inline iterator& operator+=( difference_type n ) { index += int( n ); return *this; }
+			inline iterator& operator-=( difference_type n ) { index -= int( n ); return *this; }
+			inline iterator operator+( difference_type n ) const { return { L, index + int( n ) }; }
+			inline iterator operator-( difference_type n ) const { return { L, index - int( n ) }; }
+			friend inline iterator operator+( difference_type n, const iterator& it ) { return it + n; }
+			inline difference_type operator-( const iterator& other ) const { return difference_type( index ) - difference_type( other.index ); }
+			inline bool operator==( const iterator& other ) const { return index == other.index; }
+			inline auto operator<=>( const iterator& other ) const { return index <=> other.index; }
+		};
+		template<typename T>
+		struct range
+		{
+			iterator<T> first;
+			iterator<T> last;
+			inline iterator<T> begin() const { return first; }
+			inline iterator<T> end() const { return last; }
+			inline size_t size() const { return size_t( last - first ); }
+		};
+
+		lua_State* L = nullptr;
+		int first = 1;
+		int count = 0;
+
+		// Observers.
+		//
+		inline constexpr lua_State* state() const { return L; }
+		inline constexpr size_t size() const { return size_t( count ); }
+		inline constexpr bool empty() const { return count == 0; }
+		inline constexpr int slot( size_t n ) const { return first + int( n ); }
+		inline value_type type( size_t n ) const { return stack::type( L, slot( n ) ); }
+
+		// Element access, as<T> converts the element and raises an error on mismatch while
+		// is<T> only checks it.
+		//
+		template<typename T>
+		inline bool is( size_t n ) const { return stack::check<T>( L, slot( n ) ); }
+		template<typename T>
+		inline decltype( auto ) as( size_t n ) const { return stack::get<T>( L, slot( n ) ); }
+		inline stack_object operator[]( size_t n ) const { return stack_object{ L, slot( n ), weak_t{} }; }
+
+		// Typed iteration.
+		//
+		template<typename T = stack_object>
+		inline range<T> as_range() const { return { iterator<T>{ L, first }, iterator<T>{ L, first + count } }; }
+		inline iterator<stack_object> begin() const { return { L, first }; }
+		inline iterator<stack_object> end() const { return { L, first + count }; }
+	};
+
+	// Implement type traits, consumes every slot up to the top of the stack and pushes
+	// the arguments back as multiple values.
+	//
+	template<>
+	struct type_traits<variadic_args>
+	{
+		ULUA_INLINE static int push( lua_State* L, const variadic_args& args )
+		{
+			if ( !lua_checkstack( L, args.count ) ) [[unlikely]]
+				error( L, "stack overflow (%d values)", args.count );
+			for ( int i = 0; i != args.count; i++ )
+				stack::copy( L, args.first + i );
+			return args.count;
+		}
+		ULUA_INLINE static bool check( lua_State* L, int& idx )
+		{
+			idx = std::max<int>( idx, stack::top( L ) + 1 );
+			return true;
+		}
+		ULUA_INLINE static variadic_args get( lua_State* L, int& idx )
+		{
+			int first = stack::abs( L, idx );
+			idx = std::max<int>( first, stack::top( L ) + 1 );
+			return { L, first, idx - first };
+		}
+	};
+};